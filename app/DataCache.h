@@ -0,0 +1,62 @@
+#ifndef E57INSPECTOR_DATACACHE_H
+#define E57INSPECTOR_DATACACHE_H
+
+#include "E57Utils.h"
+#include "ShardedLRUCache.h"
+
+#include <QImage>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+/**
+ * Identifies decoded data of a file: the binary section it was decoded from
+ * and the part of it, e.g. the chunk of a scan or 0 for a whole image.
+ */
+struct DataKey
+{
+    std::string file;
+    uint32_t dataId{0};
+    uint64_t chunk{0};
+
+    bool operator==(const DataKey& other) const = default;
+};
+
+template <> struct std::hash<DataKey>
+{
+    size_t operator()(const DataKey& key) const noexcept
+    {
+        size_t result = std::hash<std::string>{}(key.file);
+        for (uint64_t value : {uint64_t{key.dataId}, key.chunk})
+        {
+            result ^= std::hash<uint64_t>{}(value) + 0x9e3779b97f4a7c15 +
+                      (result << 6) + (result >> 2);
+        }
+        return result;
+    }
+};
+
+/**
+ * Chunk of a scan as handed out while decoding. Chunks only match loads
+ * with the same sampling.
+ */
+struct DecodedChunk
+{
+    SamplingOptions sampling;
+    std::shared_ptr<const PointCloudData> points;
+    uint64_t recordsRead{0};
+    uint64_t recordCount{0};
+    // the scan has no further chunks
+    bool last{false};
+};
+
+using PointChunkCache =
+    ShardedLRUCache<DataKey, std::shared_ptr<const DecodedChunk>>;
+using ImageCache = ShardedLRUCache<DataKey, QImage>;
+
+// byte budgets of the caches shared by all views of a file
+inline constexpr size_t POINT_CHUNK_CACHE_SIZE = size_t{1} << 30;
+inline constexpr size_t IMAGE_CACHE_SIZE = size_t{512} << 20;
+
+#endif // E57INSPECTOR_DATACACHE_H
@@ -0,0 +1,33 @@
+#include "E57BlobDevice.h"
+
+E57BlobDevice::E57BlobDevice(const E57Reader& reader, uint32_t blobId,
+                             QObject* parent)
+    : QIODevice(parent), m_stream(reader, blobId)
+{
+    open(QIODevice::ReadOnly);
+}
+
+qint64 E57BlobDevice::size() const
+{
+    return static_cast<qint64>(m_stream.size());
+}
+
+bool E57BlobDevice::seek(qint64 pos)
+{
+    if (pos < 0 || pos > size() || !QIODevice::seek(pos))
+        return false;
+
+    m_stream.seek(pos);
+    return true;
+}
+
+qint64 E57BlobDevice::readData(char* data, qint64 maxSize)
+{
+    return static_cast<qint64>(m_stream.read(
+        {reinterpret_cast<uint8_t*>(data), static_cast<size_t>(maxSize)}));
+}
+
+qint64 E57BlobDevice::writeData(const char*, qint64)
+{
+    return -1;
+}
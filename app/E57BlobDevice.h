@@ -0,0 +1,29 @@
+#ifndef E57INSPECTOR_E57BLOBDEVICE_H
+#define E57INSPECTOR_E57BLOBDEVICE_H
+
+#include <QIODevice>
+#include <e57inspector/E57BlobStream.h>
+
+/**
+ * Read-only random access device on top of an E57 blob, so that Qt image
+ * decoders pull the blob in chunks instead of from a full in-memory copy.
+ */
+class E57BlobDevice : public QIODevice
+{
+public:
+    E57BlobDevice(const E57Reader& reader, uint32_t blobId,
+                  QObject* parent = nullptr);
+
+    [[nodiscard]] bool isSequential() const override { return false; }
+    [[nodiscard]] qint64 size() const override;
+    bool seek(qint64 pos) override;
+
+protected:
+    qint64 readData(char* data, qint64 maxSize) override;
+    qint64 writeData(const char* data, qint64 maxSize) override;
+
+private:
+    E57BlobStream m_stream;
+};
+
+#endif // E57INSPECTOR_E57BLOBDEVICE_H
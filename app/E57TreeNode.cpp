@@ -25,6 +25,14 @@ TNodeE57::TNodeE57(const E57RootPtr& root) : TE57Node(root)
                                     dynamic_cast<E57Tree*>(this->treeWidget());
                                 tree->onAction(this, NodeAction::opXmlDump);
                             });
+    m_contextMenu.addAction("Open all scans in 3D view",
+                            [this]()
+                            {
+                                auto* tree =
+                                    dynamic_cast<E57Tree*>(this->treeWidget());
+                                tree->onAction(this,
+                                               NodeAction::opLoadProject);
+                            });
 }
 
 TNodeData3D::TNodeData3D(const E57Data3DPtr& node) : TE57Node(node)
@@ -1,19 +1,110 @@
 #include "E57Utils.h"
 #include <QImageReader>
 
+#include <e57inspector/E57ColumnReader.h>
+#include <e57inspector/E57Spherical.h>
+
+#include <cmath>
+#include <iterator>
+#include <limits>
+
+#include "E57BlobDevice.h"
+
 static const int BUFFER_SIZE = 10000;
 
 const std::string ImageFormatName[] = {"jpeg", "png"};
 
-QImage imageFromRawData(const uchar* data, int size,
-                        E57Utils::ImageFormat imageFormat)
+QImage imageFromBlob(const E57Reader& reader, uint32_t blobId,
+                     E57Utils::ImageFormat imageFormat)
 {
     // Disable image allocation limit (else 128MB)
     QImageReader::setAllocationLimit(0);
 
-    QImage image;
-    image.loadFromData(data, size, ImageFormatName[imageFormat].c_str());
-    return image;
+    // decode straight from the file, the blob is never held in memory as a
+    // whole
+    E57BlobDevice device(reader, blobId);
+    QImageReader imageReader(&device, ImageFormatName[imageFormat].c_str());
+    return imageReader.read();
+}
+
+/**
+ * @return The intensity limits of the scan, else those of the prototype, if
+ * they are finite and not empty.
+ */
+static std::optional<E57ColumnStats>
+intensityLimits(const E57Data3D& data3D, const E57DataInfo& intensityInfo)
+{
+    auto isLimited = [](double minValue, double maxValue)
+    {
+        // unlimited float fields default to the largest float or double
+        return minValue < maxValue &&
+               minValue > -std::numeric_limits<float>::max() &&
+               maxValue < std::numeric_limits<float>::max();
+    };
+
+    double minValue = intensityInfo.minValue;
+    double maxValue = intensityInfo.maxValue;
+    auto limits = std::find_if(data3D.children().begin(),
+                               data3D.children().end(), [](const auto& child)
+                               { return child->name() == "intensityLimits"; });
+    if (limits != data3D.children().end())
+    {
+        // scaled integers are kept unscaled in the node, only the limits of
+        // integer intensities are taken from there
+        const auto& floats = (*limits)->floats();
+        const auto& integers = (*limits)->integers();
+        if (floats.contains("intensityMinimum") &&
+            floats.contains("intensityMaximum") &&
+            isLimited(floats.at("intensityMinimum"),
+                      floats.at("intensityMaximum")))
+        {
+            minValue = floats.at("intensityMinimum");
+            maxValue = floats.at("intensityMaximum");
+        }
+        else if (intensityInfo.dataType == E57DataType::INTEGER &&
+                 integers.contains("intensityMinimum") &&
+                 integers.contains("intensityMaximum") &&
+                 integers.at("intensityMinimum") <
+                     integers.at("intensityMaximum"))
+        {
+            minValue = static_cast<double>(integers.at("intensityMinimum"));
+            maxValue = static_cast<double>(integers.at("intensityMaximum"));
+        }
+    }
+
+    if (!isLimited(minValue, maxValue))
+        return std::nullopt;
+
+    E57ColumnStats result;
+    result.identifier = "intensity";
+    result.minValue = minValue;
+    result.maxValue = maxValue;
+    return result;
+}
+
+void normalizeIntensity(PointCloudData& points)
+{
+    if (!points.rawIntensity)
+        return;
+
+    E57ColumnStats stats;
+    stats.minValue = std::numeric_limits<double>::max();
+    stats.maxValue = std::numeric_limits<double>::lowest();
+    for (float value : points.intensity)
+    {
+        if (std::isfinite(value))
+        {
+            stats.minValue = std::min<double>(stats.minValue, value);
+            stats.maxValue = std::max<double>(stats.maxValue, value);
+        }
+    }
+    for (auto& value : points.intensity)
+    {
+        value = std::isfinite(value)
+                    ? std::clamp(stats.normalize(value), 0.0f, 1.0f)
+                    : 0.0f;
+    }
+    points.rawIntensity = false;
 }
 
 E57Utils::E57Utils(const E57Reader& reader) : m_reader(reader) {}
@@ -55,9 +146,7 @@ std::optional<QImage> E57Utils::getImage(const E57Image2D& image2D) const
     if (!imageFormat)
         return std::nullopt;
 
-    auto rawData = m_reader.blobData(*blobId);
-    return imageFromRawData(reinterpret_cast<const uchar*>(rawData.data()),
-                            rawData.size(), *imageFormat);
+    return imageFromBlob(m_reader, *blobId, *imageFormat);
 }
 
 std::optional<QImage> E57Utils::getImageMask(const E57Image2D& image2D) const
@@ -69,9 +158,12 @@ std::optional<QImage> E57Utils::getImageMask(const E57Image2D& image2D) const
     if (!blobId)
         return std::nullopt;
 
-    auto rawData = m_reader.blobData(*blobId);
-    return imageFromRawData(reinterpret_cast<const uchar*>(rawData.data()),
-                            rawData.size(), ImageFormat::PNG);
+    return imageFromBlob(m_reader, *blobId, ImageFormat::PNG);
+}
+
+QImage E57Utils::getBlobImage(uint32_t blobId, ImageFormat imageFormat) const
+{
+    return imageFromBlob(m_reader, blobId, imageFormat);
 }
 
 std::optional<uint32_t> E57Utils::getBlobId(const E57NodePtr& node,
@@ -167,14 +259,32 @@ Matrix4d E57Utils::getPose(const E57Image2D& node)
     return e57PoseToMatrix4d(node.pose());
 }
 
-std::optional<PointCloudData> E57Utils::getData3D(E57Data3D& data3D) const
+std::optional<PointCloudData>
+E57Utils::getData3D(E57Data3D& data3D, const SamplingOptions& sampling) const
+{
+    std::optional<PointCloudData> result;
+    readData3D(
+        data3D, std::numeric_limits<uint64_t>::max(),
+        [&result](PointCloudData& chunk, uint64_t, uint64_t)
+        {
+            result = std::move(chunk);
+            return true;
+        },
+        sampling);
+    return result;
+}
+
+bool E57Utils::readData3D(E57Data3D& data3D, uint64_t chunkSize,
+                          const Data3DChunkCallback& onChunk,
+                          const SamplingOptions& sampling) const
 {
     if (!data3D.data().contains("points"))
     {
-        return std::nullopt;
+        return false;
     }
 
-    auto dataInfo = m_reader.dataInfo(data3D.data().at("points"));
+    const uint32_t dataId = data3D.data().at("points");
+    auto dataInfo = m_reader.dataInfo(dataId);
 
     auto hasAttribute = [&dataInfo](const std::string& name)
     {
@@ -183,137 +293,236 @@ std::optional<PointCloudData> E57Utils::getData3D(E57Data3D& data3D) const
                            { return info.identifier == name; });
     };
 
-    auto sphericalToCartesian = [](std::array<float, 3> rtp)
-    {
-        const float r = rtp[0];
-        const float sinTheta = std::sin(rtp[1]);
-        const float sinPhi = std::sin(rtp[2]);
-        const float cosTheta = std::cos(rtp[1]);
-        const float cosPhi = std::cos(rtp[2]);
-        return std::array<float, 3>{r * cosTheta * cosPhi,
-                                    r * cosTheta * sinPhi, r * sinTheta};
-    };
-
-    auto dataReader = m_reader.dataReader(data3D.data().at("points"));
-
     bool isSpherical = false;
-    std::vector<std::array<float, 3>> xyz(BUFFER_SIZE);
+    std::array<std::string, 3> coordinates;
     if (hasAttribute("cartesianX") && hasAttribute("cartesianY") &&
         hasAttribute("cartesianZ"))
     {
-        dataReader.bindBuffer("cartesianX", (float*)&xyz[0][0], xyz.size(),
-                              3 * sizeof(float));
-        dataReader.bindBuffer("cartesianY", (float*)&xyz[0][1], xyz.size(),
-                              3 * sizeof(float));
-        dataReader.bindBuffer("cartesianZ", (float*)&xyz[0][2], xyz.size(),
-                              3 * sizeof(float));
+        coordinates = {"cartesianX", "cartesianY", "cartesianZ"};
     }
     else if (hasAttribute("sphericalRange") &&
              hasAttribute("sphericalAzimuth") &&
              hasAttribute("sphericalElevation"))
     {
         isSpherical = true;
-        dataReader.bindBuffer("sphericalRange", (float*)&xyz[0][0], xyz.size(),
-                              3 * sizeof(float));
-        dataReader.bindBuffer("sphericalElevation", (float*)&xyz[0][1],
-                              xyz.size(), 3 * sizeof(float));
-        dataReader.bindBuffer("sphericalAzimuth", (float*)&xyz[0][2],
-                              xyz.size(), 3 * sizeof(float));
+        coordinates = {"sphericalRange", "sphericalElevation",
+                       "sphericalAzimuth"};
     }
 
-    bool hasInvalidPoints = false;
-    std::vector<int> invalid(0);
+    std::string invalidState;
     if (hasAttribute("cartesianInvalidState"))
     {
-        hasInvalidPoints = true;
-        invalid.resize(BUFFER_SIZE);
-        dataReader.bindBuffer("cartesianInvalidState", (int*)&invalid[0],
-                              invalid.size(), 1 * sizeof(int));
+        invalidState = "cartesianInvalidState";
     }
     else if (hasAttribute("sphericalInvalidState"))
     {
-        hasInvalidPoints = true;
-        invalid.resize(BUFFER_SIZE);
-        dataReader.bindBuffer("sphericalInvalidState", (int*)&invalid[0],
-                              invalid.size(), 1 * sizeof(int));
+        invalidState = "sphericalInvalidState";
     }
 
-    bool hasColor = false;
-    bool hasIntensity = false;
-    std::vector<std::array<float, 3>> rgb(0);
+    std::array<std::string, 3> colors;
     if (hasAttribute("colorRed") && hasAttribute("colorGreen") &&
         hasAttribute("colorBlue"))
     {
-        rgb.resize(BUFFER_SIZE);
-        hasColor = true;
-        dataReader.bindBuffer("colorRed", (float*)&rgb[0][0], rgb.size(),
-                              3 * sizeof(float));
-        dataReader.bindBuffer("colorGreen", (float*)&rgb[0][1], rgb.size(),
-                              3 * sizeof(float));
-        dataReader.bindBuffer("colorBlue", (float*)&rgb[0][2], rgb.size(),
-                              3 * sizeof(float));
+        colors = {"colorRed", "colorGreen", "colorBlue"};
+    }
+
+    E57ColumnReader<float, float, float, int32_t, float, float, float, float>
+        reader(m_reader.dataReader(dataId),
+               {coordinates[0], coordinates[1], coordinates[2], invalidState,
+                colors[0], colors[1], colors[2], "intensity"},
+               BUFFER_SIZE);
+
+    // neither cartesian nor spherical coordinates
+    if (!reader.hasColumn<0>() || !reader.hasColumn<1>() ||
+        !reader.hasColumn<2>())
+    {
+        return false;
     }
 
-    std::vector<float> intensity(0);
-    if (hasAttribute("intensity"))
+    const bool hasInvalidPoints = reader.hasColumn<3>();
+    const bool hasColor = reader.hasColumn<4>();
+    const bool hasIntensity = reader.hasColumn<7>();
+
+    // a single chunk is at most as large as the scan and never exceeds its
+    // capacity, smaller chunks are flushed before the next batch overflows
+    const uint64_t recordCount = reader.recordCount();
+    PointSampler sampler(sampling, recordCount);
+    const bool singleChunk = chunkSize >= recordCount;
+    chunkSize = singleChunk
+                    ? recordCount
+                    : std::max<uint64_t>(chunkSize, reader.batchSize());
+
+    // with a range known up front the intensity is normalized while
+    // decoding. The statistics are accumulated on the way unless they are
+    // cached, and cached for the next time. Without a range a single chunk is
+    // normalized by them when it is handed out, smaller chunks are handed out
+    // raw and normalized alike by their consumer.
+    auto intensityInfo =
+        std::find_if(dataInfo.begin(), dataInfo.end(), [](const auto& info)
+                     { return info.identifier == "intensity"; });
+    auto intensityStats = hasIntensity
+                              ? m_reader.cachedColumnStats(dataId, "intensity")
+                              : std::nullopt;
+    const bool accumulate = hasIntensity && !intensityStats;
+    if (accumulate && intensityInfo != dataInfo.end())
     {
-        intensity.resize(BUFFER_SIZE);
-        hasIntensity = true;
-        dataReader.bindBuffer("intensity", (float*)&intensity[0],
-                              intensity.size());
+        intensityStats = intensityLimits(data3D, *intensityInfo);
     }
+    const bool rawIntensity = hasIntensity && !intensityStats && !singleChunk;
+    E57ColumnStatsAccumulator intensityAccumulator;
+    // statistics without the skipped values are not those of the column
+    bool cacheStats = true;
+    std::vector<float> finiteIntensity;
+
+    // non-finite intensities are mapped to 0
+    auto isFinite = [](float value) { return std::isfinite(value); };
+    auto normalize = [&isFinite](const E57ColumnStats& stats, float value)
+    {
+        return isFinite(value)
+                   ? std::clamp(stats.normalize(value), 0.0f, 1.0f)
+                   : 0.0f;
+    };
 
-    uint64_t count;
-    uint64_t totalCount = 0;
+    auto toColor = [](float value)
+    { return static_cast<uint8_t>(std::clamp(value, 0.0f, 255.0f)); };
+
+    // sized up front from the record count or chunk size, so the channels
+    // never reallocate; channels the scan does not have stay empty
     PointCloudData data;
-    while ((count = dataReader.read()) > 0)
+    data.rawIntensity = rawIntensity;
+    auto reserve = [&]()
     {
-        for (size_t i = 0; i < count; ++i)
+        const auto capacity =
+            static_cast<size_t>(std::min(chunkSize, sampler.capacity()));
+        data.xyz.reserve(capacity);
+        if (hasColor)
         {
-            if (hasInvalidPoints && invalid[i] > 0)
+            data.rgba.reserve(capacity);
+        }
+        if (hasIntensity)
+        {
+            data.intensity.reserve(capacity);
+        }
+    };
+    reserve();
+
+    std::vector<std::array<float, 3>> converted(
+        isSpherical ? reader.batchSize() : 0);
+    uint64_t recordsRead = 0;
+    bool complete = true;
+
+    // hands the chunk out, the callback may move from it
+    auto flush = [&](bool last)
+    {
+        if (hasIntensity && !intensityStats && singleChunk)
+        {
+            const auto stats = intensityAccumulator.result("intensity");
+            for (auto& value : data.intensity)
             {
-                continue;
+                value = normalize(stats, value);
             }
+        }
+        bool proceed = onChunk(data, recordsRead, recordCount);
+        if (!last)
+        {
+            data.xyz.clear();
+            data.rgba.clear();
+            data.intensity.clear();
+            reserve();
+        }
+        return proceed;
+    };
 
-            if (isSpherical)
+    while (reader.read() > 0)
+    {
+        const uint64_t firstRecord = recordsRead;
+        recordsRead += reader.size();
+        auto coordinate0 = reader.column<0>();
+        auto coordinate1 = reader.column<1>();
+        auto coordinate2 = reader.column<2>();
+        auto invalid = reader.column<3>();
+        auto red = reader.column<4>();
+        auto green = reader.column<5>();
+        auto blue = reader.column<6>();
+        auto intensity = reader.column<7>();
+
+        if (accumulate)
+        {
+            if (std::all_of(intensity.begin(), intensity.end(), isFinite))
             {
-                data.xyz.push_back(sphericalToCartesian(xyz[i]));
+                intensityAccumulator.add(intensity);
             }
             else
             {
-                data.xyz.push_back(xyz[i]);
+                finiteIntensity.clear();
+                std::copy_if(intensity.begin(), intensity.end(),
+                             std::back_inserter(finiteIntensity), isFinite);
+                intensityAccumulator.add(
+                    std::span<const float>(finiteIntensity));
+                cacheStats = false;
             }
+        }
 
-            if (hasColor)
+        // range, elevation and azimuth are converted batch wise
+        if (isSpherical)
+        {
+            sphericalToCartesian(
+                coordinate0, coordinate1, coordinate2,
+                std::span(converted).first(coordinate0.size()));
+        }
+
+        for (size_t i = 0; i < reader.size(); ++i)
+        {
+            if (hasInvalidPoints && invalid[i] > 0)
             {
-                data.rgba.push_back({rgb[i][0] / 255.0f, rgb[i][1] / 255.0f,
-                                     rgb[i][2] / 255.0f, 1.0f});
+                continue;
             }
 
-            if (hasIntensity)
+            const auto xyz = isSpherical
+                                 ? converted[i]
+                                 : std::array<float, 3>{coordinate0[i],
+                                                        coordinate1[i],
+                                                        coordinate2[i]};
+            if (!sampler.accept(firstRecord + i, xyz))
             {
-                data.intensity.push_back(intensity[i]);
+                continue;
             }
-            else
+            data.xyz.push_back(xyz);
+
+            if (hasColor)
             {
-                data.intensity.push_back(1.0f);
+                data.rgba.push_back({toColor(red[i]), toColor(green[i]),
+                                     toColor(blue[i]), 255});
             }
+
+            if (hasIntensity)
+            {
+                data.intensity.push_back(
+                    intensityStats ? normalize(*intensityStats, intensity[i])
+                                   : intensity[i]);
+            }
+        }
+
+        // the rest of the scan would be dropped anyway
+        if (sampler.full())
+        {
+            complete = recordsRead >= recordCount;
+            break;
+        }
+
+        if (!singleChunk &&
+            data.xyz.size() + reader.batchSize() > chunkSize && !flush(false))
+        {
+            return false;
         }
     }
 
-    if (!data.intensity.empty())
+    // statistics of a partly decoded scan are not cached
+    if (accumulate && complete && cacheStats)
     {
-        float minIntensity =
-            *std::min_element(data.intensity.begin(), data.intensity.end());
-        float maxIntensity =
-            *std::max_element(data.intensity.begin(), data.intensity.end());
-        std::for_each(data.intensity.begin(), data.intensity.end(),
-                      [minIntensity, maxIntensity](auto& intensity)
-                      {
-                          intensity -= minIntensity;
-                          intensity /= (maxIntensity - minIntensity);
-                      });
+        m_reader.setColumnStats(dataId,
+                                intensityAccumulator.result("intensity"));
     }
 
-    return data;
+    return flush(true);
 }
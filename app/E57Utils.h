@@ -1,22 +1,43 @@
 #ifndef E57INSPECTOR_E57UTILS_H
 #define E57INSPECTOR_E57UTILS_H
 
+#include <functional>
 #include <optional>
 
 #include <QImage>
 #include <e57inspector/E57Reader.h>
 #include <e57inspector/E57Node.h>
 
+#include "PointSampler.h"
 #include "geometry.h"
 
 struct PointCloudData
 {
     std::vector<std::array<float, 3>> xyz;
     std::vector<std::array<float, 3>> normal;
+    // normalized to [0;1], unless rawIntensity is set
     std::vector<float> intensity;
-    std::vector<std::array<float, 4>> rgba;
+    std::vector<std::array<uint8_t, 4>> rgba;
+    // the intensity is as decoded, non-finite values included
+    bool rawIntensity{false};
 };
 
+/**
+ * Normalizes raw intensity to [0;1] by its finite minimum and maximum,
+ * non-finite intensities are mapped to 0. Normalized points are left alone.
+ */
+void normalizeIntensity(PointCloudData& points);
+
+/**
+ * Receives the decoded points of a scan chunk by chunk.
+ * @param chunk Decoded points, may be moved from.
+ * @param recordsRead Records decoded so far, including invalid ones.
+ * @param recordCount Records of the scan.
+ * @return False to stop reading.
+ */
+using Data3DChunkCallback = std::function<bool(
+    PointCloudData& chunk, uint64_t recordsRead, uint64_t recordCount)>;
+
 class E57Utils
 {
 public:
@@ -43,11 +64,34 @@ public:
     std::optional<E57NodePtr> getImageRepresentation(const E57Image2D& image2D) const;
     std::optional<QImage> getImage(const E57Image2D& image2D) const;
     std::optional<QImage> getImageMask(const E57Image2D& image2D) const;
+    /**
+     * Decodes an image blob, e.g. one found by getImageBlobId, without
+     * touching the node tree.
+     */
+    QImage getBlobImage(uint32_t blobId, ImageFormat imageFormat) const;
     std::optional<uint32_t> getBlobId(const E57NodePtr& node, const std::string& name) const;
     std::optional<uint32_t> getImageBlobId(const E57NodePtr& node) const;
     std::optional<ImageFormat> getImageFormat(const E57NodePtr& node) const;
     std::optional<ImageParameters> getImageParameters(const E57Image2D& image2D) const;
-    std::optional<PointCloudData> getData3D(E57Data3D& data3D) const;
+    std::optional<PointCloudData> getData3D(
+        E57Data3D& data3D, const SamplingOptions& sampling = {}) const;
+
+    /**
+     * Decodes the points of a scan and hands them out in chunks of at most
+     * chunkSize points, so they can be displayed while the rest is decoded.
+     * Invalid points are skipped and spherical coordinates are converted.
+     * Intensity is normalized to [0;1] by the same range in every chunk: its
+     * cached statistics, else the intensity limits of the scan or of the
+     * prototype. Without any of them a single chunk is normalized by the
+     * statistics of the scan, smaller chunks keep the raw intensity. The last
+     * chunk may be empty.
+     * @param sampling Points kept, decoding stops once the sample is full.
+     * @return False if the scan has no points or no coordinates, or the
+     * callback stopped reading.
+     */
+    bool readData3D(E57Data3D& data3D, uint64_t chunkSize,
+                    const Data3DChunkCallback& onChunk,
+                    const SamplingOptions& sampling = {}) const;
 
     static Matrix4d getPose(const E57Data3D& node) ;
     static Matrix4d getPose(const E57Image2D& node) ;
@@ -6,7 +6,8 @@ enum class NodeAction
     opScanPanorama,
     opXmlDump,
     opView3d,
-    opView2d
+    opView2d,
+    opLoadProject
 };
 
 #endif // E57INSPECTOR_NODEACTION_H
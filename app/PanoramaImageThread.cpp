@@ -7,16 +7,26 @@ void PanoramaImageThread::process()
 {
     try
     {
-        Panorama panorama(filename);
-        auto panoramaImage = panorama.createPanorama(guid);
-        QImage result = QImage(panoramaImage.data.data(), panoramaImage.width,
-                               panoramaImage.height, QImage::Format_RGBA8888)
-                            .copy();
-        emit panoramaImageResult(title, result);
+        // queued while the file was open
+        if (!*cancelled)
+        {
+            auto panoramaImage = panorama->createPanorama(guid);
+            QImage result =
+                QImage(panoramaImage.data.data(), panoramaImage.width,
+                       panoramaImage.height, QImage::Format_RGBA8888)
+                    .copy();
+            if (!*cancelled)
+            {
+                emit panoramaImageResult(title, result);
+            }
+        }
     }
     catch (...)
     {
-        emit panoramaImageResult("", QImage());
+        if (!*cancelled)
+        {
+            emit panoramaImageResult("", QImage());
+        }
     }
 
     emit finished();
@@ -1,23 +1,37 @@
 #ifndef E57INSPECTOR_PANORAMAIMAGETHREAD_H
 #define E57INSPECTOR_PANORAMAIMAGETHREAD_H
 
+#include "TaskScheduler.h"
+
 #include <QObject>
+#include <memory>
 #include <string>
 
+class Panorama;
+
+/**
+ * Creates the panorama of a scan as a task of the scheduler. The worker
+ * stays on the GUI thread, its signals are queued there.
+ */
 class PanoramaImageThread : public QObject
 {
     Q_OBJECT
 public:
-    std::string filename;
+    // shared by all panoramas of the file, it keeps the file open
+    std::shared_ptr<const Panorama> panorama;
     std::string guid;
     std::string title;
+    // set once the file is closed, no result is emitted then
+    TaskScheduler::CancelFlag cancelled;
 
-    PanoramaImageThread(std::string filename_, std::string guid_,
-                        std::string title_)
+    PanoramaImageThread(std::shared_ptr<const Panorama> panorama_,
+                        std::string guid_, std::string title_,
+                        TaskScheduler::CancelFlag cancelled_)
     {
-        filename = std::move(filename_);
+        panorama = std::move(panorama_);
         guid = std::move(guid_);
         title = std::move(title_);
+        cancelled = std::move(cancelled_);
     }
 
 public slots:
@@ -0,0 +1,187 @@
+#include "PointCloudLoaderThread.h"
+
+#include <e57inspector/E57Reader.h>
+
+#include <algorithm>
+
+namespace
+{
+template <typename T>
+void append(std::vector<T>& values, const std::vector<T>& chunk)
+{
+    values.insert(values.end(), chunk.begin(), chunk.end());
+}
+
+uint64_t byteSize(const PointCloudData& points)
+{
+    return points.xyz.size() * sizeof(points.xyz[0]) +
+           points.normal.size() * sizeof(points.normal[0]) +
+           points.intensity.size() * sizeof(points.intensity[0]) +
+           points.rgba.size() * sizeof(points.rgba[0]);
+}
+
+PointCloudData concatenate(
+    std::vector<std::shared_ptr<const PointCloudData>>& chunks)
+{
+    PointCloudData result;
+    uint64_t pointCount = 0;
+    for (const auto& chunk : chunks)
+    {
+        pointCount += chunk->xyz.size();
+    }
+    result.xyz.reserve(pointCount);
+    if (!chunks.front()->normal.empty())
+        result.normal.reserve(pointCount);
+    if (!chunks.front()->intensity.empty())
+        result.intensity.reserve(pointCount);
+    if (!chunks.front()->rgba.empty())
+        result.rgba.reserve(pointCount);
+    result.rawIntensity = chunks.front()->rawIntensity;
+
+    // every chunk is released as soon as it is copied, unless it is cached
+    for (auto& chunk : chunks)
+    {
+        append(result.xyz, chunk->xyz);
+        append(result.normal, chunk->normal);
+        append(result.intensity, chunk->intensity);
+        append(result.rgba, chunk->rgba);
+        chunk.reset();
+    }
+    chunks.clear();
+    return result;
+}
+} // namespace
+
+void PointCloudLoaderThread::process()
+{
+    // cancelled while queued
+    if (!*cancelled)
+    {
+        load();
+    }
+
+    emit finished();
+}
+
+void PointCloudLoaderThread::load()
+{
+    try
+    {
+        E57Reader reader(filename,
+                         E57ReaderOptions{.lazy = true, .useIndex = true});
+        const auto& data3D = reader.root()->data3D();
+        if (data3DIndex >= data3D.size())
+        {
+            throw std::runtime_error("Invalid Data3D index.");
+        }
+
+        const auto& scan = *data3D[data3DIndex];
+        if (!scan.data().contains("points"))
+        {
+            throw std::runtime_error("Data3D has no points.");
+        }
+        const uint32_t dataId = scan.data().at("points");
+
+        // the chunks are shared with the GUI thread and the cache, which
+        // only read them
+        std::vector<std::shared_ptr<const PointCloudData>> chunks;
+        bool complete = false;
+        if (auto cached = cachedChunks(dataId); !cached.empty())
+        {
+            for (const auto& chunk : cached)
+            {
+                if (*cancelled)
+                    break;
+                if (!chunk->points->xyz.empty())
+                {
+                    chunks.push_back(chunk->points);
+                    emit chunkLoaded(chunk->points);
+                }
+                emit progress(chunk->recordsRead, chunk->recordCount);
+            }
+            complete = !*cancelled;
+        }
+        else
+        {
+            uint64_t chunkIndex = 0;
+            std::shared_ptr<const DecodedChunk> lastChunk;
+            complete = E57Utils(reader).readData3D(
+                *data3D[data3DIndex], CHUNK_SIZE,
+                [&](PointCloudData& chunk, uint64_t recordsRead,
+                    uint64_t recordCount)
+                {
+                    if (*cancelled)
+                        return false;
+                    auto points = std::make_shared<const PointCloudData>(
+                        std::move(chunk));
+                    if (chunkCache)
+                    {
+                        lastChunk = std::make_shared<const DecodedChunk>(
+                            DecodedChunk{sampling, points, recordsRead,
+                                         recordCount, false});
+                        chunkCache->insert({filename, dataId, chunkIndex++},
+                                           lastChunk, byteSize(*points));
+                    }
+                    if (!points->xyz.empty())
+                    {
+                        chunks.push_back(points);
+                        emit chunkLoaded(points);
+                    }
+                    emit progress(recordsRead, recordCount);
+                    return !*cancelled;
+                },
+                sampling);
+
+            // marks the end of the scan, so later loads know the chunks are
+            // complete
+            if (complete && lastChunk)
+            {
+                auto last = std::make_shared<DecodedChunk>(*lastChunk);
+                last->last = true;
+                const uint64_t size = byteSize(*last->points);
+                chunkCache->insert({filename, dataId, chunkIndex - 1},
+                                   std::move(last), size);
+            }
+        }
+
+        if (complete && !chunks.empty())
+        {
+            // raw intensity is normalized by the range of the whole scan, as
+            // the chunks were drawn once all of them were there
+            auto points = concatenate(chunks);
+            normalizeIntensity(points);
+            auto octree = PointCloudOctree::build(
+                std::move(points), [this]() { return *cancelled; });
+            // the points are kept on disk, only the nodes on screen are
+            // read back
+            if (octree && !*cancelled)
+            {
+                auto nodeStore = std::make_shared<PointCloudNodeStore>(*octree);
+                octree.reset();
+                emit nodeStoreReady(nodeStore);
+            }
+        }
+    }
+    catch (const std::exception& ex)
+    {
+        emit error(QString::fromStdString(ex.what()));
+    }
+}
+
+std::vector<std::shared_ptr<const DecodedChunk>>
+PointCloudLoaderThread::cachedChunks(uint32_t dataId) const
+{
+    std::vector<std::shared_ptr<const DecodedChunk>> result;
+    if (!chunkCache)
+        return result;
+
+    for (uint64_t index = 0;; ++index)
+    {
+        auto chunk = chunkCache->find({filename, dataId, index});
+        if (!chunk || (*chunk)->sampling != sampling)
+            return {};
+        result.push_back(*chunk);
+        if ((*chunk)->last)
+            return result;
+    }
+}
@@ -0,0 +1,74 @@
+#ifndef E57INSPECTOR_POINTCLOUDLOADERTHREAD_H
+#define E57INSPECTOR_POINTCLOUDLOADERTHREAD_H
+
+#include "DataCache.h"
+#include "E57Utils.h"
+#include "PointCloudNodeStore.h"
+#include "TaskScheduler.h"
+
+#include <QObject>
+#include <QString>
+#include <atomic>
+#include <memory>
+#include <string>
+
+/**
+ * Decodes the points of a scan as a task of the scheduler and emits them in
+ * chunks, so they can be uploaded and drawn while the rest is decoded.
+ * Afterwards the level of detail hierarchy is built from all points and its
+ * nodes are moved to a temporary file, from where they are paged in while
+ * rendering. The worker opens its own reader, the reader of the main window
+ * is not thread-safe. The worker itself stays on the GUI thread, its signals
+ * are queued there. With a chunk cache the chunks are kept there and a scan
+ * found completely in the cache with the same sampling is not decoded again.
+ */
+class PointCloudLoaderThread : public QObject
+{
+    Q_OBJECT
+public:
+    // points per chunk handed to the scene
+    static constexpr uint64_t CHUNK_SIZE = 1 << 20;
+
+    using CancelFlag = TaskScheduler::CancelFlag;
+
+    std::string filename;
+    // position of the scan within the data3D vector
+    size_t data3DIndex;
+    // set from any thread to stop loading after the current chunk
+    CancelFlag cancelled;
+    // points kept while decoding
+    SamplingOptions sampling;
+    // shared with other loads, may be null
+    std::shared_ptr<PointChunkCache> chunkCache;
+
+    PointCloudLoaderThread(std::string filename_, size_t data3DIndex_,
+                           CancelFlag cancelled_,
+                           const SamplingOptions& sampling_ = {},
+                           std::shared_ptr<PointChunkCache> chunkCache_ = {})
+        : filename(std::move(filename_)), data3DIndex(data3DIndex_),
+          cancelled(std::move(cancelled_)), sampling(sampling_),
+          chunkCache(std::move(chunkCache_))
+    {
+    }
+
+public slots:
+    void process();
+
+signals:
+    void chunkLoaded(std::shared_ptr<const PointCloudData> chunk);
+    void nodeStoreReady(std::shared_ptr<PointCloudNodeStore> nodeStore);
+    void progress(uint64_t recordsRead, uint64_t recordCount);
+    void error(const QString& message);
+    void finished();
+
+private:
+    void load();
+    /**
+     * @return All chunks of the scan if they are cached with the sampling of
+     * this load, otherwise an empty vector.
+     */
+    std::vector<std::shared_ptr<const DecodedChunk>> cachedChunks(
+        uint32_t dataId) const;
+};
+
+#endif // E57INSPECTOR_POINTCLOUDLOADERTHREAD_H
@@ -0,0 +1,254 @@
+#include "PointCloudNodeStore.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+
+namespace
+{
+constexpr long QUANTIZATION_MAX = QuantizedPositions::QUANTIZATION_MAX;
+
+std::filesystem::path uniqueTemporaryPath()
+{
+    static std::atomic<uint64_t> counter{0};
+    std::ostringstream name;
+    name << "e57inspector-" << std::hex << std::random_device{}() << "-"
+         << counter++ << ".nodes";
+    return std::filesystem::temp_directory_path() / name.str();
+}
+
+template <typename T>
+void write(std::ofstream& ofs, const T* values, uint64_t count)
+{
+    ofs.write(reinterpret_cast<const char*>(values),
+              static_cast<std::streamsize>(count * sizeof(T)));
+}
+} // namespace
+
+QuantizedPositions quantizePositions(const PointCloudData& points,
+                                     uint64_t first, uint64_t count)
+{
+    Vector3d min(std::numeric_limits<float>::max());
+    Vector3d max(std::numeric_limits<float>::lowest());
+    for (uint64_t i = first; i < first + count; ++i)
+    {
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            min[axis] = std::min(min[axis], points.xyz[i][axis]);
+            max[axis] = std::max(max[axis], points.xyz[i][axis]);
+        }
+    }
+
+    QuantizedPositions result;
+    result.offset = count > 0 ? min : NullVector3d;
+    result.scale = count > 0 ? max - min : NullVector3d;
+
+    Vector3d quantizationScale;
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        quantizationScale[axis] =
+            result.scale[axis] > 0.0f
+                ? static_cast<float>(QUANTIZATION_MAX) / result.scale[axis]
+                : 0.0f;
+    }
+
+    auto quantize = [](float value)
+    {
+        return static_cast<uint16_t>(
+            std::clamp(std::lround(value), 0l, QUANTIZATION_MAX));
+    };
+
+    // non-finite raw intensities are mapped to the bottom of the range
+    const bool hasIntensity = !points.intensity.empty();
+    float intensityScale = static_cast<float>(QUANTIZATION_MAX);
+    if (hasIntensity && points.rawIntensity)
+    {
+        float minIntensity = std::numeric_limits<float>::max();
+        float maxIntensity = std::numeric_limits<float>::lowest();
+        for (uint64_t i = first; i < first + count; ++i)
+        {
+            if (std::isfinite(points.intensity[i]))
+            {
+                minIntensity = std::min(minIntensity, points.intensity[i]);
+                maxIntensity = std::max(maxIntensity, points.intensity[i]);
+            }
+        }
+        const bool finite = minIntensity <= maxIntensity;
+        result.intensityOffset = finite ? minIntensity : 0.0f;
+        result.intensityScale = finite ? maxIntensity - minIntensity : 0.0f;
+        intensityScale = result.intensityScale > 0.0f
+                             ? intensityScale / result.intensityScale
+                             : 0.0f;
+    }
+    auto quantizeIntensity = [&](float value)
+    {
+        return std::isfinite(value)
+                   ? quantize((value - result.intensityOffset) *
+                              intensityScale)
+                   : uint16_t{0};
+    };
+
+    const auto& offset = result.offset;
+    result.positions.resize(count);
+    for (uint64_t i = 0; i < count; ++i)
+    {
+        const auto& point = points.xyz[first + i];
+        result.positions[i] = {
+            quantize((point[0] - offset.x) * quantizationScale.x),
+            quantize((point[1] - offset.y) * quantizationScale.y),
+            quantize((point[2] - offset.z) * quantizationScale.z),
+            hasIntensity ? quantizeIntensity(points.intensity[first + i])
+                         : static_cast<uint16_t>(QUANTIZATION_MAX)};
+    }
+    return result;
+}
+
+PointCloudNodeStore::PointCloudNodeStore(const PointCloudOctree& octree)
+    : m_nodes(octree.nodes()), m_path(uniqueTemporaryPath())
+{
+    const auto& points = octree.points();
+    m_hasColor = !points.rgba.empty();
+    m_hasNormal = !points.normal.empty();
+    m_pointCount = points.xyz.size();
+    m_failed.resize(m_nodes.size());
+
+    try
+    {
+        std::ofstream ofs(m_path, std::ios::binary | std::ios::trunc);
+        ofs.exceptions(std::ios::failbit | std::ios::badbit);
+
+        uint64_t fileOffset = 0;
+        m_nodeData.reserve(m_nodes.size());
+        for (uint32_t index = 0; index < m_nodes.size(); ++index)
+        {
+            const auto& node = m_nodes[index];
+            auto quantized = quantizePositions(points, node.first, node.count);
+            write(ofs, quantized.positions.data(), node.count);
+            if (m_hasColor)
+            {
+                write(ofs, points.rgba.data() + node.first, node.count);
+            }
+            if (m_hasNormal)
+            {
+                write(ofs, points.normal.data() + node.first, node.count);
+            }
+
+            m_nodeData.push_back(
+                {quantized.offset, quantized.scale, fileOffset});
+            fileOffset += nodeByteSize(index);
+
+            BoundingBox nodeBox;
+            nodeBox.update(quantized.offset);
+            nodeBox.update(quantized.offset + quantized.scale);
+            m_boundingBox = m_boundingBox.combine(nodeBox);
+        }
+    }
+    catch (const std::exception&)
+    {
+        std::error_code ec;
+        std::filesystem::remove(m_path, ec);
+        throw std::runtime_error("Could not write temporary point file " +
+                                 m_path.string() + ".");
+    }
+
+    m_thread = std::thread(&PointCloudNodeStore::run, this);
+}
+
+PointCloudNodeStore::~PointCloudNodeStore()
+{
+    {
+        std::lock_guard lock(m_mutex);
+        m_stop = true;
+    }
+    m_condition.notify_all();
+    if (m_thread.joinable())
+    {
+        m_thread.join();
+    }
+
+    std::error_code ec;
+    std::filesystem::remove(m_path, ec);
+}
+
+uint64_t PointCloudNodeStore::pointByteSize() const
+{
+    return sizeof(std::array<uint16_t, 4>) +
+           (m_hasColor ? sizeof(std::array<uint8_t, 4>) : 0) +
+           (m_hasNormal ? sizeof(std::array<float, 3>) : 0);
+}
+
+void PointCloudNodeStore::request(const std::vector<uint32_t>& nodes)
+{
+    {
+        std::lock_guard lock(m_mutex);
+        m_requests.clear();
+        for (auto node : nodes)
+        {
+            if (node < m_nodes.size() && !m_failed[node])
+            {
+                m_requests.push_back(node);
+            }
+        }
+    }
+    m_condition.notify_one();
+}
+
+std::vector<PointCloudNodeStore::LoadedNode> PointCloudNodeStore::takeLoaded()
+{
+    std::lock_guard lock(m_mutex);
+    return std::exchange(m_loaded, {});
+}
+
+void PointCloudNodeStore::setLoadedCallback(std::function<void()> callback)
+{
+    std::lock_guard lock(m_mutex);
+    m_loadedCallback = std::move(callback);
+}
+
+void PointCloudNodeStore::run()
+{
+    std::ifstream ifs(m_path, std::ios::binary);
+    while (true)
+    {
+        uint32_t node;
+        {
+            std::unique_lock lock(m_mutex);
+            m_condition.wait(
+                lock, [this]() { return m_stop || !m_requests.empty(); });
+            if (m_stop)
+                return;
+            node = m_requests.front();
+            m_requests.pop_front();
+        }
+
+        std::vector<uint8_t> data(nodeByteSize(node));
+        ifs.seekg(static_cast<std::streamoff>(m_nodeData[node].fileOffset));
+        ifs.read(reinterpret_cast<char*>(data.data()),
+                 static_cast<std::streamsize>(data.size()));
+
+        std::function<void()> callback;
+        {
+            std::lock_guard lock(m_mutex);
+            if (ifs)
+            {
+                m_loaded.emplace_back(node, std::move(data));
+                callback = m_loadedCallback;
+            }
+            else
+            {
+                m_failed[node] = true;
+            }
+        }
+        ifs.clear();
+
+        if (callback)
+        {
+            callback();
+        }
+    }
+}
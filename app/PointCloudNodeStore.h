@@ -0,0 +1,137 @@
+#ifndef E57INSPECTOR_POINTCLOUDNODESTORE_H
+#define E57INSPECTOR_POINTCLOUDNODESTORE_H
+
+#include "E57Utils.h"
+#include "PointCloudOctree.h"
+#include "boundingbox.h"
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/**
+ * Positions of a range of points relative to their bounding box, dequantized
+ * as position = offset + scale * quantized / QUANTIZATION_MAX. The intensity
+ * is the fourth component, points without intensity are at full intensity.
+ * Raw intensity is quantized relative to its range in the same way,
+ * normalized intensity as is.
+ */
+struct QuantizedPositions
+{
+    static constexpr long QUANTIZATION_MAX = 65535;
+
+    Vector3d offset;
+    Vector3d scale;
+    float intensityOffset{0.0f};
+    float intensityScale{1.0f};
+    std::vector<std::array<uint16_t, 4>> positions;
+};
+
+/**
+ * Quantizes the positions and intensities of a range of points.
+ * @param points Points, intensity is optional.
+ * @param first Index of the first point.
+ * @param count Number of points.
+ */
+[[nodiscard]] QuantizedPositions quantizePositions(const PointCloudData& points,
+                                                   uint64_t first,
+                                                   uint64_t count);
+
+/**
+ * Keeps the nodes of an octree in a temporary file, packed for upload, and
+ * reads them back on a background thread on request. Only the node metadata
+ * stays in memory. A packed node holds count x 4 uint16 positions with
+ * intensity, followed by count x 4 uint8 colors and count x 3 float normals
+ * if the scan has them. The file is removed with the store.
+ */
+class PointCloudNodeStore
+{
+public:
+    using Ptr = std::shared_ptr<PointCloudNodeStore>;
+    using LoadedNode = std::pair<uint32_t, std::vector<uint8_t>>;
+
+    struct NodeData
+    {
+        Vector3d positionOffset;
+        Vector3d positionScale;
+        uint64_t fileOffset;
+    };
+
+    /**
+     * Packs all nodes into a new temporary file, the intensity of the points
+     * has to be normalized. A runtime exception is thrown if the file cannot
+     * be written.
+     */
+    explicit PointCloudNodeStore(const PointCloudOctree& octree);
+    ~PointCloudNodeStore();
+
+    PointCloudNodeStore(const PointCloudNodeStore&) = delete;
+    PointCloudNodeStore& operator=(const PointCloudNodeStore&) = delete;
+
+    [[nodiscard]] const std::vector<PointCloudOctree::Node>& nodes() const
+    {
+        return m_nodes;
+    }
+    [[nodiscard]] const NodeData& nodeData(uint32_t node) const
+    {
+        return m_nodeData[node];
+    }
+    [[nodiscard]] uint64_t nodeByteSize(uint32_t node) const
+    {
+        return m_nodes[node].count * pointByteSize();
+    }
+    [[nodiscard]] uint64_t pointByteSize() const;
+
+    [[nodiscard]] bool hasColor() const { return m_hasColor; }
+    [[nodiscard]] bool hasNormal() const { return m_hasNormal; }
+    [[nodiscard]] uint64_t pointCount() const { return m_pointCount; }
+    [[nodiscard]] const BoundingBox& boundingBox() const
+    {
+        return m_boundingBox;
+    }
+
+    /**
+     * Replaces the pending requests, the nodes are read in the given order.
+     * Nodes which could not be read are not requested again.
+     */
+    void request(const std::vector<uint32_t>& nodes);
+
+    /**
+     * @return Nodes read since the last call with their packed points.
+     */
+    [[nodiscard]] std::vector<LoadedNode> takeLoaded();
+
+    /**
+     * @param callback Called on the background thread after a node was read.
+     */
+    void setLoadedCallback(std::function<void()> callback);
+
+private:
+    std::vector<PointCloudOctree::Node> m_nodes;
+    std::vector<NodeData> m_nodeData;
+    bool m_hasColor{false};
+    bool m_hasNormal{false};
+    uint64_t m_pointCount{0};
+    BoundingBox m_boundingBox;
+    std::filesystem::path m_path;
+
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::deque<uint32_t> m_requests;
+    std::vector<LoadedNode> m_loaded;
+    std::vector<bool> m_failed;
+    std::function<void()> m_loadedCallback;
+    bool m_stop{false};
+    std::thread m_thread;
+
+    void run();
+};
+
+#endif // E57INSPECTOR_POINTCLOUDNODESTORE_H
@@ -0,0 +1,197 @@
+#include "PointCloudOctree.h"
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+
+namespace
+{
+template <typename T>
+void reorder(std::vector<T>& values, const std::vector<uint32_t>& order)
+{
+    if (values.empty())
+        return;
+
+    std::vector<T> result;
+    result.reserve(order.size());
+    for (auto index : order)
+    {
+        result.push_back(values[index]);
+    }
+    values = std::move(result);
+}
+} // namespace
+
+PointCloudOctree::Ptr PointCloudOctree::build(
+    PointCloudData points, const std::function<bool()>& isCancelled)
+{
+    const uint64_t pointCount = points.xyz.size();
+    if (pointCount > std::numeric_limits<uint32_t>::max())
+    {
+        throw std::runtime_error("Too many points for an octree.");
+    }
+
+    auto octree = std::make_shared<PointCloudOctree>();
+    if (pointCount == 0)
+    {
+        octree->m_points = std::move(points);
+        return octree;
+    }
+
+    Vector3d min(std::numeric_limits<float>::max());
+    Vector3d max(std::numeric_limits<float>::lowest());
+    for (const auto& point : points.xyz)
+    {
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            min[axis] = std::min(min[axis], point[axis]);
+            max[axis] = std::max(max[axis], point[axis]);
+        }
+    }
+    const Vector3d extents = max - min;
+    const float rootHalfSize = std::max(
+        {extents.x * 0.5f, extents.y * 0.5f, extents.z * 0.5f, 1e-6f});
+
+    auto& nodes = octree->m_nodes;
+    nodes.push_back({.center = (min + max) * 0.5f,
+                     .halfSize = rootHalfSize,
+                     .spacing = 2.0f * rootHalfSize / SAMPLING_GRID,
+                     .depth = 0,
+                     .first = 0,
+                     .count = pointCount});
+
+    // original index of the points, the range of a node is partitioned into
+    // its own points followed by the ranges of its children. The positions
+    // are partitioned along, so they are read sequentially.
+    std::vector<uint32_t> order(pointCount);
+    std::iota(order.begin(), order.end(), 0);
+    std::vector<uint32_t> scratch(pointCount);
+    std::vector<std::array<float, 3>> scratchXYZ(pointCount);
+    // 0 for a sampled point, otherwise 1 + octant
+    std::vector<uint8_t> slots(pointCount);
+
+    constexpr uint32_t GRID = SAMPLING_GRID;
+    std::vector<uint64_t> occupied(GRID * GRID * GRID / 64);
+    std::vector<uint32_t> occupiedCells;
+
+    struct Range
+    {
+        uint32_t node;
+        uint64_t begin;
+        uint64_t end;
+    };
+    std::vector<Range> pending{{0, 0, pointCount}};
+
+    while (!pending.empty())
+    {
+        if (isCancelled && isCancelled())
+            return nullptr;
+
+        const Range range = pending.back();
+        pending.pop_back();
+        const Node parent = nodes[range.node];
+        const uint64_t size = range.end - range.begin;
+        if (size <= LEAF_CAPACITY || parent.depth >= MAX_DEPTH)
+        {
+            nodes[range.node].first = range.begin;
+            nodes[range.node].count = size;
+            continue;
+        }
+
+        const Vector3d origin = parent.center - Vector3d(parent.halfSize);
+        const float cellScale = GRID / (2.0f * parent.halfSize);
+        auto cell = [&](float value, int axis)
+        {
+            const float position = (value - origin[axis]) * cellScale;
+            return std::min(GRID - 1,
+                            static_cast<uint32_t>(std::max(0.0f, position)));
+        };
+
+        // the first point of every cell stays in the node, the others are
+        // passed on to the child covering the cell
+        std::array<uint64_t, 9> slotCounts{};
+        for (uint64_t i = range.begin; i < range.end; ++i)
+        {
+            const auto& point = points.xyz[i];
+            const uint32_t x = cell(point[0], 0);
+            const uint32_t y = cell(point[1], 1);
+            const uint32_t z = cell(point[2], 2);
+            const uint32_t key = (x * GRID + y) * GRID + z;
+            const uint64_t bit = uint64_t{1} << (key % 64);
+
+            uint8_t slot = 0;
+            if (occupied[key / 64] & bit)
+            {
+                slot = 1 + (x >= GRID / 2 ? 1 : 0) + (y >= GRID / 2 ? 2 : 0) +
+                       (z >= GRID / 2 ? 4 : 0);
+            }
+            else
+            {
+                occupied[key / 64] |= bit;
+                occupiedCells.push_back(key);
+            }
+            slots[i] = slot;
+            ++slotCounts[slot];
+        }
+        for (auto key : occupiedCells)
+        {
+            occupied[key / 64] = 0;
+        }
+        occupiedCells.clear();
+
+        // stable counting sort of the range by slot
+        std::array<uint64_t, 9> offsets{range.begin};
+        for (size_t slot = 1; slot < offsets.size(); ++slot)
+        {
+            offsets[slot] = offsets[slot - 1] + slotCounts[slot - 1];
+        }
+        for (uint64_t i = range.begin; i < range.end; ++i)
+        {
+            const uint64_t target = offsets[slots[i]]++;
+            scratch[target] = order[i];
+            scratchXYZ[target] = points.xyz[i];
+        }
+        std::copy(scratch.begin() + range.begin, scratch.begin() + range.end,
+                  order.begin() + range.begin);
+        std::copy(scratchXYZ.begin() + range.begin,
+                  scratchXYZ.begin() + range.end,
+                  points.xyz.begin() + range.begin);
+
+        nodes[range.node].first = range.begin;
+        nodes[range.node].count = slotCounts[0];
+
+        uint64_t childBegin = range.begin + slotCounts[0];
+        const float childHalfSize = parent.halfSize * 0.5f;
+        for (uint32_t octant = 0; octant < 8; ++octant)
+        {
+            const uint64_t childSize = slotCounts[octant + 1];
+            if (childSize == 0)
+                continue;
+
+            const Vector3d direction((octant & 1) ? 1.0f : -1.0f,
+                                     (octant & 2) ? 1.0f : -1.0f,
+                                     (octant & 4) ? 1.0f : -1.0f);
+            const auto childIndex = static_cast<uint32_t>(nodes.size());
+            nodes[range.node].children[octant] = childIndex;
+            nodes.push_back(
+                {.center = parent.center + direction * childHalfSize,
+                 .halfSize = childHalfSize,
+                 .spacing = parent.spacing * 0.5f,
+                 .depth = parent.depth + 1,
+                 .first = childBegin,
+                 .count = childSize});
+            pending.push_back({childIndex, childBegin, childBegin + childSize});
+            childBegin += childSize;
+        }
+    }
+
+    scratch = {};
+    scratchXYZ = {};
+    slots = {};
+    reorder(points.normal, order);
+    reorder(points.intensity, order);
+    reorder(points.rgba, order);
+    octree->m_points = std::move(points);
+    return octree;
+}
@@ -0,0 +1,69 @@
+#ifndef E57INSPECTOR_POINTCLOUDOCTREE_H
+#define E57INSPECTOR_POINTCLOUDOCTREE_H
+
+#include "E57Utils.h"
+#include "geometry.h"
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+/**
+ * Level of detail hierarchy of a scan. Every node keeps a subsample of the
+ * points within its cube, at most one point per cell of a grid with
+ * SAMPLING_GRID cells along each axis. The other points are passed on to the
+ * eight children, so a node drawn together with its ancestors covers its
+ * cube at the node's spacing. Nodes with few points keep all of them.
+ * The points are reordered so that the points of every node are contiguous.
+ */
+class PointCloudOctree
+{
+public:
+    using Ptr = std::shared_ptr<PointCloudOctree>;
+
+    // sampling cells along each axis of a node
+    static constexpr uint32_t SAMPLING_GRID = 128;
+    // nodes with at most this many points are not subdivided
+    static constexpr uint64_t LEAF_CAPACITY = 32768;
+    static constexpr uint32_t MAX_DEPTH = 20;
+
+    struct Node
+    {
+        Vector3d center;
+        // half the edge length of the node cube
+        float halfSize;
+        // edge length of a sampling cell
+        float spacing;
+        uint32_t depth;
+        // range of the node points
+        uint64_t first;
+        uint64_t count;
+        // child node indices per octant, 0 if there is no child
+        std::array<uint32_t, 8> children{};
+    };
+
+    /**
+     * Builds the hierarchy on the calling thread.
+     * @param points Decoded points of the scan, they are reordered.
+     * @param isCancelled Polled between nodes, once it returns true the build
+     * stops and nullptr is returned.
+     */
+    [[nodiscard]] static Ptr build(
+        PointCloudData points, const std::function<bool()>& isCancelled = {});
+
+    /**
+     * @return Nodes, parents before their children, the root comes first.
+     * Empty if there are no points.
+     */
+    [[nodiscard]] const std::vector<Node>& nodes() const { return m_nodes; }
+
+    [[nodiscard]] const PointCloudData& points() const { return m_points; }
+
+private:
+    std::vector<Node> m_nodes;
+    PointCloudData m_points;
+};
+
+#endif // E57INSPECTOR_POINTCLOUDOCTREE_H
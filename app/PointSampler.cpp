@@ -0,0 +1,130 @@
+#include "PointSampler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace
+{
+constexpr uint64_t MIN_VOXEL_BITS = uint64_t{1} << 16;
+// 16 MiB, however large the scan
+constexpr uint64_t MAX_VOXEL_BITS = uint64_t{1} << 27;
+// cells further from the origin do not fit into 64 bits
+constexpr float MAX_CELL = 1e15f;
+
+// finalizer of splitmix64
+uint64_t mix(uint64_t value)
+{
+    value ^= value >> 30;
+    value *= 0xbf58476d1ce4e5b9ull;
+    value ^= value >> 27;
+    value *= 0x94d049bb133111ebull;
+    return value ^ (value >> 31);
+}
+} // namespace
+
+PointSampler::PointSampler(const SamplingOptions& options,
+                           uint64_t recordCount)
+    : m_mode(options.mode), m_recordCount(recordCount),
+      m_maxPoints(options.mode == SamplingMode::ALL
+                      ? recordCount
+                      : std::min(options.maxPoints, recordCount))
+{
+    switch (m_mode)
+    {
+    case SamplingMode::STRIDE:
+        // rounded up, so the budget holds
+        if (m_maxPoints > 0)
+        {
+            m_stride = (recordCount + m_maxPoints - 1) / m_maxPoints;
+        }
+        break;
+    case SamplingMode::VOXEL:
+        if (options.voxelSize <= 0.0f)
+        {
+            throw std::invalid_argument("Voxel size must be positive.");
+        }
+        m_inverseVoxelSize = 1.0f / options.voxelSize;
+        {
+            // a scan occupies at most one cell per record
+            uint64_t bits = MIN_VOXEL_BITS;
+            while (bits < MAX_VOXEL_BITS && bits < 4 * recordCount)
+            {
+                bits <<= 1;
+            }
+            m_voxelBits.assign(bits / 64, 0);
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+bool PointSampler::accept(uint64_t record, const std::array<float, 3>& xyz)
+{
+    if (full())
+        return false;
+
+    bool accepted = true;
+    switch (m_mode)
+    {
+    case SamplingMode::STRIDE:
+        accepted = record % m_stride == 0;
+        break;
+    case SamplingMode::UNIFORM:
+    {
+        // selection sampling, the streaming counterpart of a reservoir for a
+        // known record count: every record is kept with the probability of
+        // the missing points among the remaining records
+        const uint64_t remaining =
+            m_recordCount - std::min(record, m_recordCount);
+        accepted = remaining > 0 &&
+                   m_distribution(m_random) * static_cast<double>(remaining) <
+                       static_cast<double>(m_maxPoints - m_accepted);
+        break;
+    }
+    case SamplingMode::VOXEL:
+        accepted = acceptVoxel(record, xyz);
+        break;
+    default:
+        break;
+    }
+
+    if (accepted)
+    {
+        ++m_accepted;
+    }
+    return accepted;
+}
+
+bool PointSampler::acceptVoxel(uint64_t record,
+                               const std::array<float, 3>& xyz)
+{
+    uint64_t hash = 0;
+    for (float value : xyz)
+    {
+        const float cell = std::floor(value * m_inverseVoxelSize);
+        // false for NaN as well
+        if (!(std::abs(cell) < MAX_CELL))
+            return false;
+        hash = mix(hash ^ static_cast<uint64_t>(static_cast<int64_t>(cell)));
+    }
+
+    const uint64_t bit = hash & (m_voxelBits.size() * 64 - 1);
+    const uint64_t mask = uint64_t{1} << (bit % 64);
+    if (m_voxelBits[bit / 64] & mask)
+        return false;
+    m_voxelBits[bit / 64] |= mask;
+    ++m_voxels;
+
+    // the first point of a cell is kept with the probability of the missing
+    // points among the cells still to come, estimated from the rate at which
+    // new cells turned up so far. The budget is spread over the whole scan
+    // rather than used up by the cells decoded first.
+    const double rate =
+        static_cast<double>(m_voxels) / static_cast<double>(record + 1);
+    const uint64_t remaining = m_recordCount - std::min(record, m_recordCount);
+    const double expected = rate * static_cast<double>(remaining);
+    return m_distribution(m_random) * expected <
+           static_cast<double>(m_maxPoints - m_accepted);
+}
@@ -0,0 +1,82 @@
+#ifndef E57INSPECTOR_POINTSAMPLER_H
+#define E57INSPECTOR_POINTSAMPLER_H
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <vector>
+
+enum class SamplingMode
+{
+    // every point, the point budget does not apply
+    ALL = 0,
+    // every n-th record
+    STRIDE = 1,
+    // uniformly random records
+    UNIFORM = 2,
+    // the first point within each cell of a voxel grid, a random subset of
+    // the cells if there are more than the budget
+    VOXEL = 3
+};
+
+struct SamplingOptions
+{
+    SamplingMode mode{SamplingMode::ALL};
+    // points kept at most
+    uint64_t maxPoints{std::numeric_limits<uint64_t>::max()};
+    // edge length of a voxel for SamplingMode::VOXEL
+    float voxelSize{0.01f};
+
+    bool operator==(const SamplingOptions& other) const = default;
+};
+
+/**
+ * Decides while decoding which points of a scan are kept, so a preview of a
+ * large scan never holds more than the point budget in memory. The records
+ * have to be passed in order. Invalid records may be left out, they count
+ * against the STRIDE, UNIFORM and VOXEL samples though, which then keep
+ * fewer points. Points with a non-finite position are not kept in VOXEL mode.
+ */
+class PointSampler
+{
+public:
+    PointSampler(const SamplingOptions& options, uint64_t recordCount);
+
+    /**
+     * @param record Index of the record within the scan.
+     * @param xyz Cartesian position of the point.
+     * @return True if the point is kept.
+     */
+    [[nodiscard]] bool accept(uint64_t record, const std::array<float, 3>& xyz);
+
+    /**
+     * @return True once no further point will be accepted, the rest of the
+     * scan need not be decoded.
+     */
+    [[nodiscard]] bool full() const { return m_accepted >= m_maxPoints; }
+
+    /**
+     * @return Upper bound of the points kept.
+     */
+    [[nodiscard]] uint64_t capacity() const { return m_maxPoints; }
+
+private:
+    SamplingMode m_mode;
+    uint64_t m_recordCount;
+    uint64_t m_maxPoints;
+    uint64_t m_accepted{0};
+    uint64_t m_stride{1};
+    float m_inverseVoxelSize{0.0f};
+    std::mt19937_64 m_random;
+    std::uniform_real_distribution<double> m_distribution{0.0, 1.0};
+    // occupied cells as a hashed bitmap of bounded size, cells sharing a bit
+    // count as one
+    std::vector<uint64_t> m_voxelBits;
+    uint64_t m_voxels{0};
+
+    [[nodiscard]] bool acceptVoxel(uint64_t record,
+                                   const std::array<float, 3>& xyz);
+};
+
+#endif // E57INSPECTOR_POINTSAMPLER_H
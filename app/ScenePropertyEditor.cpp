@@ -13,6 +13,8 @@
 #include "camera.h"
 #include "pointcloud.h"
 
+#include <cmath>
+
 ScenePropertyEditor::ScenePropertyEditor(QWidget* parent)
     : CPropertyEditor(parent)
 {
@@ -73,6 +75,28 @@ void ScenePropertyEditor::initFromCamera()
     auto* perspectiveCamera = new CBoolProperty(
         "perspectiveCamera", "Perspective", camera->perspective(), true);
     add(perspectiveCamera);
+
+    // in million points
+    auto* pointBudget = new CIntegerProperty(
+        "pointBudget", "Point Budget (M)",
+        static_cast<int>(camera->scene()->pointBudget() / 1000000),
+        static_cast<int>(Scene::DEFAULT_POINT_BUDGET / 1000000), 1, 1000);
+    add(pointBudget);
+
+    auto* loadBudget = new CIntegerProperty(
+        "loadBudget", "Load Budget (M)",
+        static_cast<int>(camera->scene()->loadBudget() / 1000000),
+        static_cast<int>(Scene::DEFAULT_LOAD_BUDGET / 1000000), 1, 100000);
+    add(loadBudget);
+
+    auto* culling = new CBoolProperty("culling", "Frustum Culling",
+                                      camera->scene()->culling(), true);
+    add(culling);
+
+    auto* showRenderStats =
+        new CBoolProperty("showRenderStats", "Show Statistics",
+                          camera->scene()->showRenderStats(), false);
+    add(showRenderStats);
 }
 
 void ScenePropertyEditor::initFromPointcloud()
@@ -108,6 +132,37 @@ void ScenePropertyEditor::initFromPointcloud()
     auto* singleColor = new CColorProperty(viewProperties, "singleColor",
                                            "Color", pointcloud->singleColor());
     add(singleColor);
+
+    // changing the sampling loads the scan again
+    const auto& sampling = pointcloud->sampling();
+    auto* samplingProperties =
+        new CPropertyHeader("SamplingProperties", "Sampling Settings");
+    add(samplingProperties);
+
+    CListData samplingModes;
+    samplingModes.append(CListDataItem(QString("All"), QIcon(), QVariant(0)));
+    samplingModes.append(
+        CListDataItem(QString("Stride"), QIcon(), QVariant(1)));
+    samplingModes.append(
+        CListDataItem(QString("Uniform"), QIcon(), QVariant(2)));
+    samplingModes.append(CListDataItem(QString("Voxel"), QIcon(), QVariant(3)));
+    auto* samplingMode =
+        new CListProperty(samplingProperties, "samplingMode", "Mode",
+                          samplingModes, static_cast<int>(sampling.mode),
+                          static_cast<int>(SamplingMode::UNIFORM));
+    add(samplingMode);
+
+    // in million points
+    auto* maxPoints = new CDoubleProperty(
+        samplingProperties, "maxPoints", "Max Points (M)",
+        static_cast<double>(sampling.maxPoints) / 1000000.0, 1.0, 0.001,
+        100000.0);
+    add(maxPoints);
+
+    auto* voxelSize =
+        new CDoubleProperty(samplingProperties, "voxelSize", "Voxel Size",
+                            sampling.voxelSize, 0.01, 0.0001, 1000.0);
+    add(voxelSize);
 }
 
 void ScenePropertyEditor::initFromImage2d()
@@ -166,6 +221,32 @@ void ScenePropertyEditor::changeFromCamera(QTreeWidgetItem* item)
     {
         camera->setPerspective(*perspectiveCamera);
     }
+
+    auto pointBudget = getIntegerValue(item, "pointBudget");
+    if (pointBudget)
+    {
+        camera->scene()->setPointBudget(static_cast<uint64_t>(*pointBudget) *
+                                        1000000);
+    }
+
+    auto loadBudget = getIntegerValue(item, "loadBudget");
+    if (loadBudget)
+    {
+        camera->scene()->setLoadBudget(static_cast<uint64_t>(*loadBudget) *
+                                       1000000);
+    }
+
+    auto culling = getBooleanValue(item, "culling");
+    if (culling)
+    {
+        camera->scene()->setCulling(*culling);
+    }
+
+    auto showRenderStats = getBooleanValue(item, "showRenderStats");
+    if (showRenderStats)
+    {
+        camera->scene()->setShowRenderStats(*showRenderStats);
+    }
 }
 
 void ScenePropertyEditor::changeFromPointcloud(QTreeWidgetItem* item)
@@ -194,6 +275,34 @@ void ScenePropertyEditor::changeFromPointcloud(QTreeWidgetItem* item)
     {
         pointcloud->setSingleColor(*singleColor);
     }
+
+    // the properties are also reported while they are set up, only actual
+    // changes load the scan again
+    const auto& current = pointcloud->sampling();
+    auto sampling = current;
+    auto samplingMode = getListIndex(item, "samplingMode");
+    auto maxPoints = getDoubleValue(item, "maxPoints");
+    auto voxelSize = getDoubleValue(item, "voxelSize");
+    if (samplingMode)
+    {
+        sampling.mode = static_cast<SamplingMode>(*samplingMode);
+    }
+    if (maxPoints)
+    {
+        sampling.maxPoints =
+            static_cast<uint64_t>(std::llround(*maxPoints * 1000000.0));
+    }
+    if (voxelSize)
+    {
+        sampling.voxelSize = static_cast<float>(*voxelSize);
+    }
+    if (sampling.mode != current.mode ||
+        sampling.maxPoints != current.maxPoints ||
+        sampling.voxelSize != current.voxelSize)
+    {
+        pointcloud->setSampling(sampling);
+        emit pointcloud->scene()->reloadRequested(pointcloud);
+    }
 }
 
 void ScenePropertyEditor::changeFromImage2d(QTreeWidgetItem* item)
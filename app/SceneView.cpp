@@ -67,6 +67,10 @@ void SceneView::paintGL()
     while (m_scene->invokeAgain())
     {
         m_scene->setInvokeAgain(false);
+        m_scene->resetRenderStats();
+        // the level of detail follows the camera of this frame
+        m_camera->updateMatrices();
+        PointCloud::selectNodes(*m_scene, *m_camera);
         m_scene->render();
     }
     painter.endNativePainting();
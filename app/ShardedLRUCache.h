@@ -0,0 +1,156 @@
+#ifndef E57INSPECTOR_SHARDEDLRUCACHE_H
+#define E57INSPECTOR_SHARDEDLRUCACHE_H
+
+#include "silrucache.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+/**
+ * Least-recently-used cache which may be shared between threads. The keys
+ * are distributed over shards by their hash, every shard is a SiLRUCache with
+ * its own lock and an equal part of the byte budget, so threads working on
+ * different keys rarely wait for each other. Values are returned by copy,
+ * large values should be held by shared pointers.
+ */
+template <typename Key, typename Value> class ShardedLRUCache
+{
+public:
+    static constexpr size_t DEFAULT_SHARD_COUNT = 16;
+
+    struct Stats
+    {
+        uint64_t hits{0};
+        uint64_t misses{0};
+        uint64_t evictions{0};
+        // bytes of all items currently cached
+        size_t size{0};
+    };
+
+    /**
+     * @param capacity Byte budget of all shards together.
+     * @param shardCount Number of shards, at least one.
+     */
+    explicit ShardedLRUCache(size_t capacity,
+                             size_t shardCount = DEFAULT_SHARD_COUNT)
+        : m_capacity(capacity)
+    {
+        shardCount = std::max<size_t>(shardCount, 1);
+        m_shards.reserve(shardCount);
+        for (size_t i = 0; i < shardCount; ++i)
+        {
+            m_shards.push_back(
+                std::make_unique<Shard>(capacity / shardCount, m_evictions));
+        }
+    }
+
+    ShardedLRUCache(const ShardedLRUCache&) = delete;
+    ShardedLRUCache& operator=(const ShardedLRUCache&) = delete;
+
+    /**
+     * @return Copy of the cached value, which becomes the most recently used
+     * one of its shard, or nullopt on a miss.
+     */
+    [[nodiscard]] std::optional<Value> find(const Key& key)
+    {
+        auto& shard = shardOf(key);
+        std::lock_guard lock(shard.mutex);
+        if (!shard.cache.contains(key))
+        {
+            ++m_misses;
+            return std::nullopt;
+        }
+        ++m_hits;
+        return shard.cache.getItem(key).value();
+    }
+
+    /**
+     * Adds or replaces a value, least recently used values of the shard are
+     * evicted to make room. Values larger than a shard are not cached.
+     * @param size Size of the value in bytes.
+     */
+    void insert(const Key& key, Value value, size_t size)
+    {
+        auto& shard = shardOf(key);
+        std::lock_guard lock(shard.mutex);
+        if (size > shard.cache.capacity())
+        {
+            shard.cache.removeItem(key);
+            return;
+        }
+        shard.cache.addItem(key,
+                            typename Shard::Cache::CacheItemType(
+                                std::move(value), size));
+    }
+
+    void erase(const Key& key)
+    {
+        auto& shard = shardOf(key);
+        std::lock_guard lock(shard.mutex);
+        shard.cache.removeItem(key);
+    }
+
+    void clear()
+    {
+        for (auto& shard : m_shards)
+        {
+            std::lock_guard lock(shard->mutex);
+            shard->cache.reset();
+        }
+    }
+
+    [[nodiscard]] size_t capacity() const { return m_capacity; }
+
+    /**
+     * @return Counters since construction, the shards are read one after
+     * another, so the size is not a snapshot while other threads insert.
+     */
+    [[nodiscard]] Stats stats() const
+    {
+        Stats result{m_hits.load(), m_misses.load(), m_evictions.load(), 0};
+        for (const auto& shard : m_shards)
+        {
+            std::lock_guard lock(shard->mutex);
+            result.size += shard->cache.size();
+        }
+        return result;
+    }
+
+private:
+    struct Shard
+    {
+        using Cache = SiLRUCache<Key, Value, size_t>;
+
+        mutable std::mutex mutex;
+        Cache cache;
+
+        Shard(size_t capacity, std::atomic<uint64_t>& evictions)
+            : cache(capacity)
+        {
+            cache.setEvictionCallback([&evictions](const Key&, auto&)
+                                      { ++evictions; });
+        }
+    };
+
+    size_t m_capacity;
+    std::vector<std::unique_ptr<Shard>> m_shards;
+    std::atomic<uint64_t> m_hits{0};
+    std::atomic<uint64_t> m_misses{0};
+    std::atomic<uint64_t> m_evictions{0};
+
+    Shard& shardOf(const Key& key)
+    {
+        // the high bits of the mixed hash, the shard maps use the low ones
+        const uint64_t hash =
+            static_cast<uint64_t>(std::hash<Key>{}(key)) * 0x9e3779b97f4a7c15;
+        return *m_shards[(hash >> 32) % m_shards.size()];
+    }
+};
+
+#endif // E57INSPECTOR_SHARDEDLRUCACHE_H
@@ -0,0 +1,176 @@
+#include "TaskScheduler.h"
+
+#include <algorithm>
+
+namespace
+{
+// index of the worker running on this thread, SIZE_MAX on other threads
+thread_local const TaskScheduler* currentScheduler = nullptr;
+thread_local size_t currentWorker = SIZE_MAX;
+} // namespace
+
+TaskScheduler::TaskScheduler(size_t threadCount)
+    : m_backgroundLimit(std::max<size_t>(threadCount, 2) - 1)
+{
+    threadCount = std::max<size_t>(threadCount, 1);
+    m_workers.reserve(threadCount);
+    for (size_t i = 0; i < threadCount; ++i)
+    {
+        m_workers.push_back(std::make_unique<Worker>());
+    }
+    // started once all queues exist, the workers steal from each other
+    for (size_t i = 0; i < threadCount; ++i)
+    {
+        m_workers[i]->thread = std::thread(&TaskScheduler::run, this, i);
+    }
+}
+
+TaskScheduler::~TaskScheduler()
+{
+    {
+        std::lock_guard lock(m_sleepMutex);
+        m_stop = true;
+    }
+    m_condition.notify_all();
+    for (auto& worker : m_workers)
+    {
+        worker->thread.join();
+    }
+}
+
+size_t TaskScheduler::defaultThreadCount()
+{
+    return std::max(2u, std::thread::hardware_concurrency());
+}
+
+TaskScheduler::CancelFlag TaskScheduler::createCancelFlag()
+{
+    return std::make_shared<std::atomic<bool>>(false);
+}
+
+std::shared_future<void> TaskScheduler::submit(Task task,
+                                               TaskPriority priority)
+{
+    Entry entry{std::move(task), {}};
+    auto future = entry.done.get_future().share();
+
+    const auto lane = static_cast<size_t>(priority);
+    const size_t index = currentScheduler == this
+                             ? currentWorker
+                             : m_nextWorker++ % m_workers.size();
+    {
+        // counted under the queue lock, so the counter never drops below the
+        // queued tasks
+        std::lock_guard lock(m_workers[index]->mutex);
+        m_workers[index]->queues[lane].push_back(std::move(entry));
+        ++m_queued[lane];
+    }
+    notify();
+    return future;
+}
+
+void TaskScheduler::run(size_t index)
+{
+    currentScheduler = this;
+    currentWorker = index;
+
+    while (true)
+    {
+        Entry entry;
+        TaskPriority priority;
+        if (!take(index, entry, priority))
+        {
+            std::unique_lock lock(m_sleepMutex);
+            m_condition.wait(lock,
+                             [this]() { return m_stop || hasRunnableTask(); });
+            if (m_stop)
+                return;
+            continue;
+        }
+
+        try
+        {
+            entry.task();
+            entry.done.set_value();
+        }
+        catch (...)
+        {
+            entry.done.set_exception(std::current_exception());
+        }
+
+        // a background slot became free
+        if (priority == TaskPriority::BACKGROUND)
+        {
+            --m_runningBackground;
+            notify();
+        }
+    }
+}
+
+bool TaskScheduler::take(size_t index, Entry& entry, TaskPriority& priority)
+{
+    if (m_queued[0] > 0 && takeFrom(index, 0, entry))
+    {
+        priority = TaskPriority::INTERACTIVE;
+        return true;
+    }
+
+    // a background slot is reserved before looking for a task
+    size_t running = m_runningBackground;
+    do
+    {
+        if (m_queued[1] == 0 || running >= m_backgroundLimit)
+            return false;
+    } while (!m_runningBackground.compare_exchange_weak(running, running + 1));
+
+    if (takeFrom(index, 1, entry))
+    {
+        priority = TaskPriority::BACKGROUND;
+        return true;
+    }
+    --m_runningBackground;
+    return false;
+}
+
+bool TaskScheduler::takeFrom(size_t index, size_t priority, Entry& entry)
+{
+    // the own queue first, oldest task first, then the newest task of the
+    // other workers
+    for (size_t i = 0; i < m_workers.size(); ++i)
+    {
+        auto& worker = *m_workers[(index + i) % m_workers.size()];
+        std::lock_guard lock(worker.mutex);
+        auto& queue = worker.queues[priority];
+        if (queue.empty())
+            continue;
+
+        if (i == 0)
+        {
+            entry = std::move(queue.front());
+            queue.pop_front();
+        }
+        else
+        {
+            entry = std::move(queue.back());
+            queue.pop_back();
+        }
+        --m_queued[priority];
+        return true;
+    }
+    return false;
+}
+
+bool TaskScheduler::hasRunnableTask() const
+{
+    return m_queued[0] > 0 ||
+           (m_queued[1] > 0 && m_runningBackground < m_backgroundLimit);
+}
+
+void TaskScheduler::notify()
+{
+    // taking the lock orders the counters before a worker checks them
+    {
+        std::lock_guard lock(m_sleepMutex);
+    }
+    m_condition.notify_all();
+}
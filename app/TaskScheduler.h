@@ -0,0 +1,99 @@
+#ifndef E57INSPECTOR_TASKSCHEDULER_H
+#define E57INSPECTOR_TASKSCHEDULER_H
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+enum class TaskPriority
+{
+    // started by the user and waited for, e.g. a panorama or an image
+    INTERACTIVE = 0,
+    // long running, e.g. loading a scan
+    BACKGROUND = 1
+};
+
+/**
+ * Fixed pool of worker threads shared by all jobs of the application. Every
+ * worker has a queue per priority; tasks submitted from a worker stay on its
+ * queue, others are spread over the workers, and idle workers steal from the
+ * queues of busy ones. Interactive tasks are taken before background tasks,
+ * and background tasks never occupy all workers, so an interactive task
+ * starts without waiting for a background task to finish.
+ * Tasks are not preempted. Cancellation is cooperative: a task polls its
+ * cancel flag and returns early, it is run even if it was cancelled while
+ * queued, so it can report back.
+ */
+class TaskScheduler
+{
+public:
+    using Task = std::function<void()>;
+    // set from any thread to ask the tasks holding it to stop
+    using CancelFlag = std::shared_ptr<std::atomic<bool>>;
+
+    /**
+     * @param threadCount Number of workers, by default one per core.
+     */
+    explicit TaskScheduler(size_t threadCount = defaultThreadCount());
+    /**
+     * Waits until all tasks have run, including the queued ones. Tasks which
+     * should not finish their work are to be cancelled first.
+     */
+    ~TaskScheduler();
+
+    TaskScheduler(const TaskScheduler&) = delete;
+    TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+    [[nodiscard]] static size_t defaultThreadCount();
+    [[nodiscard]] static CancelFlag createCancelFlag();
+
+    /**
+     * Queues the task, exceptions thrown by it are passed to the future.
+     * @return Becomes ready once the task has run.
+     */
+    std::shared_future<void> submit(Task task, TaskPriority priority);
+
+    [[nodiscard]] size_t threadCount() const { return m_workers.size(); }
+
+private:
+    static constexpr size_t PRIORITY_COUNT = 2;
+
+    struct Entry
+    {
+        Task task;
+        std::promise<void> done;
+    };
+
+    struct Worker
+    {
+        std::mutex mutex;
+        std::array<std::deque<Entry>, PRIORITY_COUNT> queues;
+        std::thread thread;
+    };
+
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    std::atomic<size_t> m_nextWorker{0};
+    std::array<std::atomic<size_t>, PRIORITY_COUNT> m_queued{};
+    std::atomic<size_t> m_runningBackground{0};
+    size_t m_backgroundLimit;
+
+    std::mutex m_sleepMutex;
+    std::condition_variable m_condition;
+    bool m_stop{false};
+
+    void run(size_t index);
+    bool take(size_t index, Entry& entry, TaskPriority& priority);
+    bool takeFrom(size_t index, size_t priority, Entry& entry);
+    [[nodiscard]] bool hasRunnableTask() const;
+    void notify();
+};
+
+#endif // E57INSPECTOR_TASKSCHEDULER_H
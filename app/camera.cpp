@@ -1,6 +1,7 @@
 #include "camera.h"
 
 #include <array>
+#include <limits>
 #include <queue>
 #include <set>
 
@@ -51,7 +52,7 @@ void Camera::renderBoundingBox(QPainter& painter,
     }
 }
 
-void Camera::configureShader()
+void Camera::updateMatrices()
 {
     m_view =
         glm::lookAt(Vector3d(m_position), Vector3d(m_center), Vector3d(m_up));
@@ -68,6 +69,29 @@ void Camera::configureShader()
         m_projection = glm::ortho(-m_orthoSize * aspect, m_orthoSize * aspect,
                                   -m_orthoSize, m_orthoSize, m_near, m_far);
     }
+}
+
+float Camera::projectedSize(const Vector3d& center, float radius) const
+{
+    const float pixelsPerUnit = m_projection[1][1] * 0.5f *
+                                static_cast<float>(m_viewportHeight);
+    if (!m_perspectiveCamera)
+    {
+        return 2.0f * radius * pixelsPerUnit;
+    }
+
+    const float distance =
+        VectorLength(Vector3d(m_view * Vector4d(center, 1.0f)));
+    if (distance <= radius)
+    {
+        return std::numeric_limits<float>::infinity();
+    }
+    return 2.0f * radius * pixelsPerUnit / distance;
+}
+
+void Camera::configureShader()
+{
+    updateMatrices();
 
     if (auto location = getUniformLocation("view"))
     {
@@ -27,6 +27,23 @@ public:
     void renderBoundingBox(QPainter& painter, const BoundingBox& boundingBox);
     void configureShader() override;
 
+    /**
+     * Updates the view and projection matrices from the camera position and
+     * the scene extents, configureShader does so as well.
+     */
+    void updateMatrices();
+    [[nodiscard]] const Matrix4d& view() const { return m_view; }
+    [[nodiscard]] const Matrix4d& projection() const { return m_projection; }
+
+    /**
+     * @return Approximate diameter in pixels of a sphere on screen, infinity
+     * if the camera is inside of it.
+     * @param center Sphere center in world coordinates.
+     * @param radius Sphere radius.
+     */
+    [[nodiscard]] float projectedSize(const Vector3d& center,
+                                      float radius) const;
+
     void yaw(float angle);
     void pitch(float angle);
 
@@ -0,0 +1,70 @@
+#ifndef E57INSPECTOR_FRUSTUM_H
+#define E57INSPECTOR_FRUSTUM_H
+
+#include "boundingbox.h"
+#include "geometry.h"
+
+#include <array>
+
+/**
+ * View frustum as six planes (left, right, bottom, top, near, far) pointing
+ * inwards, a point p is inside a plane if dot(plane.xyz, p) + plane.w >= 0.
+ */
+struct Frustum
+{
+    std::array<Vector4d, 6> planes{};
+
+    /**
+     * Extracts the planes from the rows of a view projection matrix
+     * (Gribb/Hartmann).
+     * @param viewProjection Projection matrix multiplied by the view matrix.
+     * @return Frustum in the coordinate system the view matrix maps from.
+     */
+    [[nodiscard]] static inline Frustum fromMatrix(
+        const Matrix4d& viewProjection)
+    {
+        // glm matrices are column-major
+        auto row = [&viewProjection](int i)
+        {
+            return Vector4d(viewProjection[0][i], viewProjection[1][i],
+                            viewProjection[2][i], viewProjection[3][i]);
+        };
+
+        Frustum result;
+        result.planes = {row(3) + row(0), row(3) - row(0), row(3) + row(1),
+                         row(3) - row(1), row(3) + row(2), row(3) - row(2)};
+        for (auto& plane : result.planes)
+        {
+            const float length = VectorLength(Vector3d(plane));
+            if (length > 0.0f)
+            {
+                plane /= length;
+            }
+        }
+        return result;
+    }
+
+    /**
+     * Tests the corner of the box furthest along each plane normal, so boxes
+     * are never reported outside while a part of them is visible. Boxes near
+     * the frustum edges may be reported as intersecting although they are
+     * not.
+     * @return False if the box is completely outside of the frustum.
+     */
+    [[nodiscard]] inline bool intersects(const BoundingBox& box) const
+    {
+        for (const auto& plane : planes)
+        {
+            const Vector3d corner(plane.x >= 0.0f ? box.max.x : box.min.x,
+                                  plane.y >= 0.0f ? box.max.y : box.min.y,
+                                  plane.z >= 0.0f ? box.max.z : box.min.z);
+            if (VectorDot(Vector3d(plane), corner) + plane.w < 0.0f)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+#endif // E57INSPECTOR_FRUSTUM_H
@@ -6,6 +6,7 @@
 #include "PanoramaImageThread.h"
 #include "SceneView.h"
 #include "about.h"
+#include "panorama.h"
 #include "siimageviewer.h"
 #include "version.h"
 #include "welcome.h"
@@ -20,12 +21,15 @@
 #include <QMessageBox>
 #include <QMimeData>
 #include <QTextEdit>
-#include <QThread>
 
 static const int BUFFER_SIZE = 10000;
 
 MainWindow::MainWindow(QWidget* parent)
-    : QMainWindow(parent), ui(new Ui::MainWindow)
+    : QMainWindow(parent), ui(new Ui::MainWindow),
+      m_pointChunkCache(
+          std::make_shared<PointChunkCache>(POINT_CHUNK_CACHE_SIZE)),
+      m_imageCache(IMAGE_CACHE_SIZE),
+      m_fileCancelled(TaskScheduler::createCancelFlag())
 {
     ui->setupUi(this);
     setAcceptDrops(true);
@@ -85,6 +89,18 @@ MainWindow::MainWindow(QWidget* parent)
                                 std::string(INFO_PRODUCTVERSION_STRING);
     ui->statusbar->showMessage(QString::fromStdString(statusBarText));
 
+    m_loadProgressBar = new QProgressBar(ui->statusbar);
+    m_loadProgressBar->setRange(0, 1000);
+    m_loadProgressBar->setMaximumWidth(250);
+    m_loadCancelButton = new QToolButton(ui->statusbar);
+    m_loadCancelButton->setText(tr("Cancel"));
+    m_loadCancelButton->setToolTip(tr("Cancel loading point clouds"));
+    ui->statusbar->addPermanentWidget(m_loadProgressBar);
+    ui->statusbar->addPermanentWidget(m_loadCancelButton);
+    connect(m_loadCancelButton, &QToolButton::clicked, this,
+            [this]() { cancelPointCloudLoads(); });
+    updateLoadProgress();
+
     // workaround for closing and reopening window
     auto* sceneView = new SceneView();
     int index = ui->tabWidget->addTab(sceneView, "");
@@ -94,6 +110,9 @@ MainWindow::MainWindow(QWidget* parent)
 
 MainWindow::~MainWindow()
 {
+    // the scheduler runs the queued and running tasks, they return early
+    *m_fileCancelled = true;
+    cancelPointCloudLoads();
     delete ui;
 }
 
@@ -243,8 +262,17 @@ void MainWindow::openFile()
 
 void MainWindow::loadE57(const std::string& filename)
 {
+    cancelPointCloudLoads();
+    *m_fileCancelled = true;
+    m_fileCancelled = TaskScheduler::createCancelFlag();
+    // the file may have changed since it was cached
+    m_pointChunkCache->clear();
+    m_imageCache.clear();
     m_filename = filename;
-    m_reader = std::make_unique<E57Reader>(filename);
+    // running panoramas keep the previous one
+    m_panorama = std::make_shared<const Panorama>(filename);
+    m_reader = std::make_unique<E57Reader>(
+        filename, E57ReaderOptions{.lazy = true, .useIndex = true});
     ui->twMain->init(m_reader->root());
     ui->twViewProperties->init(nullptr);
     ui->tabWidget->clear();
@@ -314,6 +342,10 @@ void MainWindow::twMain_onAction(const TNode* node, NodeAction action)
         {
             showXMLDump();
         }
+        else if (action == NodeAction::opLoadProject)
+        {
+            loadProject();
+        }
     }
 
     if (dynamic_cast<const TNodeData3D*>(node) != nullptr)
@@ -322,24 +354,18 @@ void MainWindow::twMain_onAction(const TNode* node, NodeAction action)
 
         if (action == NodeAction::opScanPanorama)
         {
-            QThread* thread = new QThread();
-            PanoramaImageThread* worker = new PanoramaImageThread(
-                m_filename, data3DNode->node()->getString("guid"),
-                data3DNode->node()->name() + std::string(" Scan Panorama"));
-            worker->moveToThread(thread);
-
-            connect(worker, SIGNAL(error(QString)), this,
-                    SLOT(errorString(QString)));
-            connect(thread, &QThread::started, worker,
-                    &PanoramaImageThread::process);
+            auto* worker = new PanoramaImageThread(
+                m_panorama, data3DNode->node()->getString("guid"),
+                data3DNode->node()->name() + std::string(" Scan Panorama"),
+                m_fileCancelled);
+
+            // the worker stays on the GUI thread, its signals are queued
             connect(worker, &PanoramaImageThread::panoramaImageResult, this,
                     &MainWindow::onPanoramaImageThreadFinished);
-            connect(worker, &PanoramaImageThread::finished, thread,
-                    &QThread::quit);
             connect(worker, &PanoramaImageThread::finished, worker,
                     &PanoramaImageThread::deleteLater);
-            connect(thread, &QThread::finished, thread, &QThread::deleteLater);
-            thread->start();
+            m_scheduler.submit([worker]() { worker->process(); },
+                               TaskPriority::INTERACTIVE);
         }
         else if (action == NodeAction::opView3d)
         {
@@ -373,6 +399,7 @@ void MainWindow::tabWidget_tabClosesRequested(int index)
     if (index == -1)
         return;
     QWidget* tabItem = ui->tabWidget->widget(index);
+    cancelPointCloudLoads(dynamic_cast<SceneView*>(tabItem));
     ui->tabWidget->removeTab(index);
     delete tabItem;
     tabItem = nullptr;
@@ -478,12 +505,14 @@ void MainWindow::sceneView_itemDropped(SceneView* sender, QObject* source)
                 }
             }
 
-            auto image = utils.getImage(*e57NodeImage2D);
+            // the image and its mask are decoded in parallel
+            auto imageResult = loadImage(*e57NodeImage2D, false);
+            auto imageMaskResult = loadImage(*e57NodeImage2D, true);
+            const auto& image = imageResult.get();
             if (!image)
                 return;
             image2d->setImage(*image);
-            auto imageMask = utils.getImageMask(*e57NodeImage2D);
-            if (imageMask)
+            if (const auto& imageMask = imageMaskResult.get())
             {
                 image2d->setImageMask(*imageMask);
             }
@@ -527,16 +556,6 @@ void MainWindow::sceneView_itemDropped(SceneView* sender, QObject* source)
         {
             auto e57NodeData3D =
                 std::dynamic_pointer_cast<E57Data3D>(nodeData3D->node());
-            auto dataInfo =
-                m_reader->dataInfo(e57NodeData3D->data().at("points"));
-
-            bool isFirstObject = sender->scene().nodes().size() < 2;
-            if (isFirstObject)
-            {
-                sender->scene().setPose(
-                    InverseMatrix(E57Utils::getPose(*e57NodeData3D)));
-            }
-
             if (sceneViewCreated)
             {
                 ui->tabWidget->setTabText(
@@ -544,30 +563,9 @@ void MainWindow::sceneView_itemDropped(SceneView* sender, QObject* source)
                     QString::fromStdString(e57NodeData3D->name()));
             }
 
-            auto pointCloud =
-                std::make_shared<PointCloud>(nullptr, e57NodeData3D);
-            auto data = E57Utils(*m_reader).getData3D(*e57NodeData3D);
-
-            if (data)
-            {
-                if (!data->rgba.empty())
-                {
-                    pointCloud->setViewType(PointCloudViewType::COLOR);
-                }
-                else if (!data->intensity.empty())
-                {
-                    pointCloud->setViewType(PointCloudViewType::INTENSITY);
-                }
-                else
-                {
-                    pointCloud->setViewType(PointCloudViewType::SINGLECOLOR);
-                    pointCloud->setSingleColor(Qt::white);
-                }
-
-                pointCloud->setPose(E57Utils::getPose(*e57NodeData3D));
-                pointCloud->setPointCloudData(*data);
-                sender->scene().addNode(pointCloud);
-            }
+            addPointCloud(sender, e57NodeData3D,
+                          {.mode = SamplingMode::UNIFORM},
+                          sceneViewCreated && topView);
         }
     }
 
@@ -587,17 +585,193 @@ void MainWindow::sceneView_itemDropped(SceneView* sender, QObject* source)
     }
 }
 
-void MainWindow::openImage(const E57Image2D& node, const std::string& tabName)
+void MainWindow::loadProject()
 {
-    auto image = E57Utils(*m_reader).getImage(node);
-    if (!image)
+    if (!m_reader)
         return;
 
-    auto* imageViewer = new SiImageViewer(ui->tabWidget);
-    int tabIndex =
-        ui->tabWidget->addTab(imageViewer, QString::fromStdString(tabName));
-    ui->tabWidget->setCurrentIndex(tabIndex);
-    imageViewer->setImage(*image);
+    std::vector<std::pair<E57Data3DPtr, uint64_t>> scans;
+    uint64_t totalRecords = 0;
+    for (const auto& data3D : m_reader->root()->data3D())
+    {
+        if (!data3D->data().contains("points"))
+            continue;
+        const uint64_t recordCount =
+            m_reader->recordCount(data3D->data().at("points"));
+        scans.emplace_back(data3D, recordCount);
+        totalRecords += recordCount;
+    }
+    if (scans.empty())
+        return;
+
+    auto* sceneView = createSceneView(m_reader->root()->name());
+    sceneView->makeCurrent();
+
+    // the scans share the load budget by their size, otherwise the first
+    // ones would use it up
+    const uint64_t loadBudget = sceneView->scene().loadBudget();
+    for (const auto& [data3D, recordCount] : scans)
+    {
+        SamplingOptions sampling{.mode = SamplingMode::UNIFORM};
+        sampling.maxPoints =
+            totalRecords > loadBudget
+                ? static_cast<uint64_t>(static_cast<double>(loadBudget) *
+                                        static_cast<double>(recordCount) /
+                                        static_cast<double>(totalRecords))
+                : recordCount;
+        addPointCloud(sceneView, data3D, sampling, true);
+    }
+
+    sceneView->update();
+    ui->twScene->init(sceneView->scene());
+    ui->twViewProperties->clear();
+}
+
+std::shared_ptr<PointCloud> MainWindow::addPointCloud(
+    SceneView* sceneView, const E57Data3DPtr& data3D,
+    const SamplingOptions& sampling, bool fitCamera)
+{
+    auto dataInfo = m_reader->dataInfo(data3D->data().at("points"));
+
+    // the scene is centered on the first object
+    bool isFirstObject = sceneView->scene().nodes().size() < 2;
+    if (isFirstObject)
+    {
+        sceneView->scene().setPose(InverseMatrix(E57Utils::getPose(*data3D)));
+    }
+
+    auto hasAttribute = [&dataInfo](const std::string& name)
+    {
+        return std::any_of(dataInfo.begin(), dataInfo.end(),
+                           [&name](const auto& info)
+                           { return info.identifier == name; });
+    };
+    const bool hasColor = hasAttribute("colorRed");
+    const bool hasIntensity = hasAttribute("intensity");
+
+    auto pointCloud = std::make_shared<PointCloud>(nullptr, data3D);
+    if (hasColor)
+    {
+        pointCloud->setViewType(PointCloudViewType::COLOR);
+    }
+    else if (hasIntensity)
+    {
+        pointCloud->setViewType(PointCloudViewType::INTENSITY);
+    }
+    else
+    {
+        pointCloud->setViewType(PointCloudViewType::SINGLECOLOR);
+        pointCloud->setSingleColor(Qt::white);
+    }
+    pointCloud->setPose(E57Utils::getPose(*data3D));
+    pointCloud->setSampling(sampling);
+
+    // the points are decoded in the background and drawn as they arrive,
+    // the node is added right away
+    sceneView->scene().addNode(pointCloud);
+    loadPointCloud(sceneView, pointCloud, fitCamera);
+    return pointCloud;
+}
+
+void MainWindow::openImage(const E57Image2D& node, const std::string& tabName)
+{
+    // the tab is added once the image is decoded, the GUI stays responsive
+    // in the meantime
+    loadImage(node, false,
+              [this, tabName](const std::optional<QImage>& image)
+              {
+                  if (!image)
+                      return;
+                  auto* imageViewer = new SiImageViewer(ui->tabWidget);
+                  int tabIndex = ui->tabWidget->addTab(
+                      imageViewer, QString::fromStdString(tabName));
+                  ui->tabWidget->setCurrentIndex(tabIndex);
+                  imageViewer->setImage(*image);
+              });
+}
+
+std::shared_future<std::optional<QImage>> MainWindow::loadImage(
+    const E57Image2D& image2D, bool mask,
+    const std::function<void(const std::optional<QImage>&)>& onLoaded)
+{
+    auto promise = std::make_shared<std::promise<std::optional<QImage>>>();
+    auto result = promise->get_future().share();
+    // onLoaded is called on the GUI thread, unless the file was closed
+    // meanwhile
+    auto finish = [this, promise, result, onLoaded,
+                   cancelled = m_fileCancelled](std::optional<QImage> image)
+    {
+        promise->set_value(std::move(image));
+        if (!onLoaded)
+            return;
+        QMetaObject::invokeMethod(
+            this,
+            [result, onLoaded, cancelled]()
+            {
+                if (!*cancelled)
+                {
+                    onLoaded(result.get());
+                }
+            },
+            Qt::QueuedConnection);
+    };
+
+    // the node tree is only read on the GUI thread
+    E57Utils utils(*m_reader);
+    std::optional<uint32_t> blobId;
+    std::optional<E57Utils::ImageFormat> imageFormat;
+    if (auto representation = utils.getImageRepresentation(image2D))
+    {
+        blobId = mask ? utils.getBlobId(*representation, "imageMask")
+                      : utils.getImageBlobId(*representation);
+        imageFormat = mask ? E57Utils::ImageFormat::PNG
+                           : utils.getImageFormat(*representation);
+    }
+    if (!blobId || !imageFormat)
+    {
+        finish(std::nullopt);
+        return result;
+    }
+
+    const DataKey key{m_filename, *blobId, 0};
+    if (auto image = m_imageCache.find(key))
+    {
+        finish(std::move(image));
+        return result;
+    }
+
+    // the task opens its own reader, the one of the main window is not
+    // thread-safe
+    m_scheduler.submit(
+        [this, finish, key, imageFormat = *imageFormat,
+         cancelled = m_fileCancelled]()
+        {
+            std::optional<QImage> image;
+            // the file was closed while the task was queued
+            if (*cancelled)
+            {
+                finish(std::move(image));
+                return;
+            }
+            try
+            {
+                E57Reader reader(key.file, E57ReaderOptions{.lazy = true,
+                                                            .useIndex = true});
+                image = E57Utils(reader).getBlobImage(key.dataId, imageFormat);
+                if (!image->isNull() && !*cancelled)
+                {
+                    m_imageCache.insert(
+                        key, *image, static_cast<size_t>(image->sizeInBytes()));
+                }
+            }
+            catch (...)
+            {
+                image.reset();
+            }
+            finish(std::move(image));
+        },
+        TaskPriority::INTERACTIVE);
+    return result;
 }
 
 void MainWindow::createEditor(const std::string& title,
@@ -673,13 +847,216 @@ void MainWindow::dropEvent(QDropEvent* event)
     }
 }
 
-void MainWindow::closeEvent(QCloseEvent* event) {}
+void MainWindow::closeEvent(QCloseEvent* event)
+{
+    cancelPointCloudLoads(nullptr, true);
+}
+
+void MainWindow::loadPointCloud(SceneView* sceneView,
+                                const std::shared_ptr<PointCloud>& pointCloud,
+                                bool fitCamera)
+{
+    const auto& scans = m_reader->root()->data3D();
+    const auto scan =
+        std::find_if(scans.begin(), scans.end(), [&pointCloud](const auto& node)
+                     { return node.get() == &pointCloud->data3D(); });
+    if (scan == scans.end())
+        return;
+    const auto data3DIndex = static_cast<size_t>(scan - scans.begin());
+
+    const uint32_t dataId = (*scan)->data().at("points");
+    const uint64_t recordCount = m_reader->recordCount(dataId);
+    const auto dataInfo = m_reader->dataInfo(dataId);
+    const bool hasColor =
+        std::any_of(dataInfo.begin(), dataInfo.end(), [](const auto& info)
+                    { return info.identifier == "colorRed"; });
+
+    // a subsampled scan gets what the other scans have left of the load
+    // budget
+    auto& scene = sceneView->scene();
+    uint64_t loaded = 0;
+    for (const auto& node : scene.nodes())
+    {
+        auto* other = dynamic_cast<PointCloud*>(node.get());
+        if (other && other != pointCloud.get())
+        {
+            loaded += other->sampling().maxPoints;
+        }
+    }
+    const uint64_t available =
+        scene.loadBudget() - std::min(loaded, scene.loadBudget());
+    auto sampling = pointCloud->sampling();
+    if (sampling.mode == SamplingMode::ALL)
+    {
+        sampling.maxPoints = recordCount;
+    }
+    else
+    {
+        sampling.maxPoints =
+            std::min({sampling.maxPoints, recordCount, available});
+        if (sampling.maxPoints == 0)
+        {
+            ui->statusbar->showMessage(
+                tr("The load budget of the scene is used up."), 5000);
+        }
+    }
+    pointCloud->setSampling(sampling);
+
+    // the preview is limited to the point budget, the whole scan is only
+    // drawn through its octree
+    sceneView->makeCurrent();
+    pointCloud->reservePoints(std::min(sampling.maxPoints, scene.pointBudget()),
+                              hasColor);
+
+    const uint64_t id = m_nextPointCloudLoadId++;
+    auto cancelled = TaskScheduler::createCancelFlag();
+
+    // the worker stays on the GUI thread, its signals are queued
+    auto* worker = new PointCloudLoaderThread(
+        m_filename, data3DIndex, cancelled, sampling, m_pointChunkCache);
+    m_pointCloudLoads[id] = {cancelled, {}, sceneView, pointCloud.get(), 0, 0};
+
+    // chunks are uploaded on the GUI thread. The connection ends with the
+    // view, the node may have been removed from the scene meanwhile.
+    std::weak_ptr<PointCloud> weakPointCloud = pointCloud;
+    connect(worker, &PointCloudLoaderThread::chunkLoaded, sceneView,
+            [sceneView, weakPointCloud,
+             cancelled](const std::shared_ptr<const PointCloudData>& chunk)
+            {
+                auto pointCloud = weakPointCloud.lock();
+                if (!pointCloud || *cancelled)
+                    return;
+                sceneView->makeCurrent();
+                pointCloud->appendPointCloudData(*chunk);
+                sceneView->update();
+            });
+    // the nodes replace the chunks, from then on the point budget holds
+    connect(worker, &PointCloudLoaderThread::nodeStoreReady, sceneView,
+            [sceneView, weakPointCloud,
+             cancelled](const std::shared_ptr<PointCloudNodeStore>& nodeStore)
+            {
+                auto pointCloud = weakPointCloud.lock();
+                if (!pointCloud || *cancelled)
+                    return;
+                sceneView->makeCurrent();
+                pointCloud->setNodeStore(nodeStore);
+                sceneView->update();
+            });
+    connect(worker, &PointCloudLoaderThread::progress, this,
+            [this, id](uint64_t recordsRead, uint64_t recordCount)
+            {
+                auto it = m_pointCloudLoads.find(id);
+                if (it == m_pointCloudLoads.end())
+                    return;
+                it->second.recordsRead = recordsRead;
+                it->second.recordCount = recordCount;
+                updateLoadProgress();
+            });
+    connect(worker, &PointCloudLoaderThread::error, this,
+            [this](const QString& message)
+            {
+                QMessageBox::critical(this, tr("Error"),
+                                      tr("Could not load point cloud: ") +
+                                          message);
+            });
+    connect(worker, &PointCloudLoaderThread::finished, this,
+            [this, id, cancelled, fitCamera,
+             view = QPointer<SceneView>(sceneView)]()
+            {
+                m_pointCloudLoads.erase(id);
+                updateLoadProgress();
+                // the camera is fitted once, to the last scan of the view
+                const bool viewLoading = std::any_of(
+                    m_pointCloudLoads.begin(), m_pointCloudLoads.end(),
+                    [&view](const auto& load)
+                    { return load.second.sceneView == view; });
+                if (fitCamera && view && !*cancelled && !viewLoading)
+                {
+                    view->makeCurrent();
+                    if (auto* camera = view->scene().findNode<Camera>())
+                    {
+                        camera->topView();
+                    }
+                    view->update();
+                }
+            });
+
+    connect(worker, &PointCloudLoaderThread::finished, worker,
+            &PointCloudLoaderThread::deleteLater);
+    m_pointCloudLoads[id].done = m_scheduler.submit(
+        [worker]() { worker->process(); }, TaskPriority::BACKGROUND);
+    updateLoadProgress();
+}
+
+void MainWindow::reloadPointCloud(SceneView* sceneView, SceneNode* node)
+{
+    const auto& nodes = sceneView->scene().nodes();
+    auto it = std::find_if(nodes.begin(), nodes.end(), [node](const auto& ptr)
+                           { return ptr.get() == node; });
+    auto pointCloud = it != nodes.end()
+                          ? std::dynamic_pointer_cast<PointCloud>(*it)
+                          : nullptr;
+    if (!pointCloud)
+        return;
+
+    // chunks of the running load are dropped once it is cancelled
+    for (auto& [id, load] : m_pointCloudLoads)
+    {
+        if (load.pointCloud == pointCloud.get())
+        {
+            *load.cancelled = true;
+        }
+    }
+    loadPointCloud(sceneView, pointCloud, false);
+    sceneView->update();
+}
+
+void MainWindow::updateLoadProgress()
+{
+    uint64_t recordsRead = 0;
+    uint64_t recordCount = 0;
+    for (const auto& [id, load] : m_pointCloudLoads)
+    {
+        recordsRead += load.recordsRead;
+        recordCount += load.recordCount;
+    }
+
+    const bool loading = !m_pointCloudLoads.empty();
+    m_loadProgressBar->setVisible(loading);
+    m_loadCancelButton->setVisible(loading);
+    if (!loading)
+        return;
+
+    m_loadProgressBar->setValue(
+        recordCount > 0 ? static_cast<int>(recordsRead * 1000 / recordCount)
+                        : 0);
+    m_loadProgressBar->setFormat(
+        tr("Loading %n scan(s): %p%", "",
+           static_cast<int>(m_pointCloudLoads.size())));
+}
+
+void MainWindow::cancelPointCloudLoads(const SceneView* sceneView, bool wait)
+{
+    for (auto& [id, load] : m_pointCloudLoads)
+    {
+        if (sceneView && load.sceneView != sceneView)
+            continue;
+        *load.cancelled = true;
+        if (wait && load.done.valid())
+        {
+            load.done.wait();
+        }
+    }
+}
 
 SceneView* MainWindow::createSceneView(const std::string& name)
 {
     auto sceneView = new SceneView(ui->tabWidget);
     connect(sceneView, &SceneView::itemDropped, this,
             &MainWindow::sceneView_itemDropped);
+    connect(&sceneView->scene(), &Scene::reloadRequested, this,
+            [this, sceneView](SceneNode* node)
+            { reloadPointCloud(sceneView, node); });
     int tabIndex =
         ui->tabWidget->addTab(sceneView, QString::fromStdString(name));
     ui->tabWidget->setCurrentIndex(tabIndex);
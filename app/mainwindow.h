@@ -2,13 +2,22 @@
 #define E57INSPECTOR_MAINWINDOW_H
 
 #include <QMainWindow>
+#include <QPointer>
 #include <QProgressBar>
+#include <QToolButton>
+
+#include <functional>
+#include <future>
+#include <map>
 
 #include <e57inspector/E57Reader.h>
 
+#include "DataCache.h"
 #include "E57TreeNode.h"
 #include "NodeAction.h"
+#include "PointCloudLoaderThread.h"
 #include "SceneView.h"
+#include "TaskScheduler.h"
 
 QT_BEGIN_NAMESPACE
 namespace Ui
@@ -17,6 +26,8 @@ class MainWindow;
 }
 QT_END_NAMESPACE
 
+class Panorama;
+
 class MainWindow : public QMainWindow
 {
     Q_OBJECT
@@ -54,17 +65,90 @@ private slots:
     void onPanoramaImageThreadFinished(const std::string& title, QImage image);
 
 private:
+    struct PointCloudLoad
+    {
+        PointCloudLoaderThread::CancelFlag cancelled;
+        // ready once the task has run
+        std::shared_future<void> done;
+        QPointer<SceneView> sceneView;
+        // only compared, the node may be gone
+        const PointCloud* pointCloud{nullptr};
+        uint64_t recordsRead{0};
+        uint64_t recordCount{0};
+    };
+
     Ui::MainWindow* ui;
     std::string m_filename;
     std::unique_ptr<E57Reader> m_reader;
+    std::map<uint64_t, PointCloudLoad> m_pointCloudLoads;
+    uint64_t m_nextPointCloudLoadId{0};
+    QProgressBar* m_loadProgressBar;
+    QToolButton* m_loadCancelButton;
+    // decoded data shared by all views and tabs of the file
+    std::shared_ptr<PointChunkCache> m_pointChunkCache;
+    ImageCache m_imageCache;
+    // creates the panoramas of the file, reusing its readers
+    std::shared_ptr<const Panorama> m_panorama;
+    // set once the file is closed, stops its panorama and image tasks
+    TaskScheduler::CancelFlag m_fileCancelled;
+    // declared last, the running tasks finish before the caches are gone
+    TaskScheduler m_scheduler;
 
     void openFile();
     void openImage(const E57Image2D& node, const std::string& tabName);
+    /**
+     * Decodes the image or its mask as an interactive task, or takes it from
+     * the image cache.
+     * @param onLoaded Called with the result on the GUI thread.
+     * @return Holds nullopt if there is no such image.
+     */
+    std::shared_future<std::optional<QImage>> loadImage(
+        const E57Image2D& image2D, bool mask,
+        const std::function<void(const std::optional<QImage>&)>& onLoaded =
+            {});
     void createEditor(const std::string& title, const std::string& content);
     void showXMLDump();
     SceneView* createSceneView(const std::string& name = "New View");
 
     SceneView* findSceneView();
+
+    /**
+     * Opens all scans of the file in a new view, registered by their poses.
+     * They are decoded in parallel and share the load budget of the scene by
+     * their record counts.
+     */
+    void loadProject();
+    /**
+     * Adds a scan to the view and starts loading it.
+     * @param sampling Sampling of the scan, maxPoints is limited to the load
+     * budget the other scans of the scene have left.
+     */
+    std::shared_ptr<PointCloud> addPointCloud(SceneView* sceneView,
+                                              const E57Data3DPtr& data3D,
+                                              const SamplingOptions& sampling,
+                                              bool fitCamera);
+
+    /**
+     * Decodes the points as a background task, subsampled as set for the point
+     * cloud within the load budget of the scene, and uploads them chunk by
+     * chunk. Previously loaded points of the point cloud are discarded.
+     * @param fitCamera Shows the whole point cloud from the top once loaded.
+     */
+    void loadPointCloud(SceneView* sceneView,
+                        const std::shared_ptr<PointCloud>& pointCloud,
+                        bool fitCamera);
+    /**
+     * Cancels a running load of the point cloud and loads it again with its
+     * current sampling settings.
+     */
+    void reloadPointCloud(SceneView* sceneView, SceneNode* node);
+    void updateLoadProgress();
+    /**
+     * Stops loading point clouds, of the given view or all.
+     * @param wait Blocks until the tasks have finished.
+     */
+    void cancelPointCloudLoads(const SceneView* sceneView = nullptr,
+                               bool wait = false);
 };
 
 #endif // E57INSPECTOR_MAINWINDOW_H
@@ -34,7 +34,8 @@ OpenGLArrayBuffer::OpenGLArrayBuffer(
         throw std::runtime_error("Invalid enumerator for componentType."); break;
     }
 
-    _byteSize = _elementCount * _componentCount * _componentByteSize;
+    _byteSize = static_cast<GLsizeiptr>(_elementCount) * _componentCount *
+                _componentByteSize;
 
     _buffer = 0;
     glGenBuffers(1, &_buffer);
@@ -42,6 +43,47 @@ OpenGLArrayBuffer::OpenGLArrayBuffer(
     glBufferData(type, _byteSize, data, usage);
 }
 
+void OpenGLArrayBuffer::setSubData(GLsizei elementOffset,
+                                   GLsizei elementCount, const void* data)
+{
+    if (elementOffset < 0 || elementCount < 0 ||
+        elementOffset + static_cast<GLsizeiptr>(elementCount) > _elementCount)
+    {
+        throw std::runtime_error("Buffer range out of bounds.");
+    }
+
+    const GLsizeiptr elementSize = _componentCount * _componentByteSize;
+    glBindBuffer(GL_ARRAY_BUFFER, _buffer);
+    glBufferSubData(GL_ARRAY_BUFFER, elementOffset * elementSize,
+                    elementCount * elementSize, data);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void OpenGLArrayBuffer::setVertexAttribute(GLuint index, bool normalized,
+                                           GLint count, GLint offset)
+{
+    glBindBuffer(GL_ARRAY_BUFFER, _buffer);
+    glVertexAttribPointer(
+        index, count > 0 ? count : _componentCount, _componentType,
+        normalized ? GL_TRUE : GL_FALSE, _componentCount * _componentByteSize,
+        reinterpret_cast<const void*>(
+            static_cast<uintptr_t>(offset * _componentByteSize)));
+    glEnableVertexAttribArray(index);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void OpenGLArrayBuffer::setVertexAttribute(GLuint index, GLenum type,
+                                           GLint count, bool normalized,
+                                           GLsizei stride, GLintptr byteOffset)
+{
+    glBindBuffer(GL_ARRAY_BUFFER, _buffer);
+    glVertexAttribPointer(
+        index, count, type, normalized ? GL_TRUE : GL_FALSE, stride,
+        reinterpret_cast<const void*>(static_cast<uintptr_t>(byteOffset)));
+    glEnableVertexAttribArray(index);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
 OpenGLArrayBuffer::~OpenGLArrayBuffer()
 {
     if (_buffer != 0)
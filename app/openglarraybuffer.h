@@ -24,15 +24,53 @@ public:
     GLsizei componentByteSize(void) const { return _componentByteSize; }
     GLint componentCount(void) const { return _componentCount; }
     GLsizei elementCount(void) const { return _elementCount; }
-    GLsizei byteSize(void) const { return _byteSize; }
+    GLsizeiptr byteSize(void) const { return _byteSize; }
     GLuint buffer(void) const { return _buffer; }
 
+    /**
+     * Sets up a vertex attribute of the bound vertex array reading from this
+     * buffer.
+     * @param index Attribute location.
+     * @param normalized Maps integer components to [0;1], or [-1;1] for
+     * signed types, used to dequantize compact vertex formats.
+     * @param count Components of the attribute, 0 for all components of an
+     * element.
+     * @param offset Index of the first component within an element.
+     */
+    void setVertexAttribute(GLuint index, bool normalized = false,
+                            GLint count = 0, GLint offset = 0);
+
+    /**
+     * Sets up a vertex attribute of the bound vertex array reading a block of
+     * this buffer, e.g. when several attributes of different types are stored
+     * one after another.
+     * @param index Attribute location.
+     * @param type Component type of the attribute.
+     * @param count Components of the attribute.
+     * @param normalized Maps integer components to [0;1] or [-1;1].
+     * @param stride Bytes from one element to the next.
+     * @param byteOffset Byte offset of the first element.
+     */
+    void setVertexAttribute(GLuint index, GLenum type, GLint count,
+                            bool normalized, GLsizei stride,
+                            GLintptr byteOffset);
+
+    /**
+     * Overwrites a range of elements, e.g. to fill a buffer created without
+     * data chunk by chunk.
+     * @param elementOffset Index of the first element to write.
+     * @param elementCount Number of elements to write.
+     * @param data Elements to write.
+     */
+    void setSubData(GLsizei elementOffset, GLsizei elementCount,
+                    const void* data);
+
 private:
     GLenum _componentType;
     GLsizei _componentByteSize;
     GLint _componentCount;
     GLsizei _elementCount;
-    GLsizei _byteSize;
+    GLsizeiptr _byteSize;
     GLuint _buffer;
 };
 
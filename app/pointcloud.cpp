@@ -1,8 +1,13 @@
 #include "pointcloud.h"
 #include "ShaderFactory.h"
 #include "camera.h"
+#include "frustum.h"
 
+#include <algorithm>
 #include <array>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
 #include <queue>
 #include <utility>
 
@@ -17,10 +22,14 @@ PointCloud::PointCloud(SceneNode* parent, E57Data3DPtr data3D)
 
 PointCloud::~PointCloud()
 {
-    if (m_vao >= 0)
+    releaseNodes();
+    for (auto vao : {m_vao, m_nodeVao})
     {
-        GLuint vao = m_vao;
-        glDeleteVertexArrays(1, &vao);
+        if (vao >= 0)
+        {
+            GLuint name = vao;
+            glDeleteVertexArrays(1, &name);
+        }
     }
 }
 
@@ -39,10 +48,113 @@ void PointCloud::render()
         camera->configureShader();
     }
 
-    if (m_vao > 0)
+    // every chunk and node is quantized relative to its own bounding box
+    auto& stats = scene()->renderStats();
+    auto offsetLocation = getUniformLocation("positionOffset");
+    auto scaleLocation = getUniformLocation("positionScale");
+    auto intensityOffsetLocation = getUniformLocation("intensityOffset");
+    auto intensityScaleLocation = getUniformLocation("intensityScale");
+    auto draw = [&](const Vector3d& positionOffset,
+                    const Vector3d& positionScale, float intensityOffset,
+                    float intensityScale, GLint first, GLsizei count)
+    {
+        ++stats.chunksRendered;
+        stats.pointsRendered += static_cast<uint64_t>(count);
+        if (offsetLocation)
+        {
+            glUniform3fv(*offsetLocation, 1, &positionOffset[0]);
+        }
+        if (scaleLocation)
+        {
+            glUniform3fv(*scaleLocation, 1, &positionScale[0]);
+        }
+        if (intensityOffsetLocation)
+        {
+            glUniform1f(*intensityOffsetLocation, intensityOffset);
+        }
+        if (intensityScaleLocation)
+        {
+            glUniform1f(*intensityScaleLocation, intensityScale);
+        }
+        glDrawArrays(GL_POINTS, first, count);
+    };
+
+    if (m_nodeStore && m_nodeVao > 0)
     {
+        auto& cache = scene()->bufferCache();
+        const auto pointByteSize =
+            static_cast<GLintptr>(m_nodeStore->pointByteSize());
+        glBindVertexArray(m_nodeVao);
+        for (auto node : m_visibleNodes)
+        {
+            if (!cache.contains(nodeKey(node)))
+                continue;
+
+            // the attributes of a node are stored one after another
+            auto& buffer = *cache.getItem(nodeKey(node)).value();
+            const auto count =
+                static_cast<GLsizei>(m_nodeStore->nodes()[node].count);
+            GLintptr offset = 0;
+            buffer.setVertexAttribute(0, GL_UNSIGNED_SHORT, 3, true, 8, 0);
+            buffer.setVertexAttribute(2, GL_UNSIGNED_SHORT, 1, true, 8, 6);
+            offset += GLintptr{8} * count;
+            if (m_nodeStore->hasColor())
+            {
+                buffer.setVertexAttribute(3, GL_UNSIGNED_BYTE, 4, true, 4,
+                                          offset);
+                offset += GLintptr{4} * count;
+            }
+            if (m_nodeStore->hasNormal())
+            {
+                buffer.setVertexAttribute(1, GL_FLOAT, 3, false, 12, offset);
+            }
+
+            // the intensity of the nodes is normalized
+            const auto& nodeData = m_nodeStore->nodeData(node);
+            draw(nodeData.positionOffset, nodeData.positionScale, 0.0f, 1.0f,
+                 0, count);
+        }
+        glBindVertexArray(0);
+    }
+    else if (m_vao > 0)
+    {
+        // the octree nodes are culled by selectNodes, the chunks of a scan
+        // which is still loading here
+        std::optional<Frustum> frustum;
+        if (camera && scene()->culling())
+        {
+            frustum =
+                Frustum::fromMatrix(camera->projection() * camera->view());
+        }
+        const Matrix4d model = modelMatrix();
+        const float intensityRange = m_intensityMaximum - m_intensityMinimum;
+
         glBindVertexArray(m_vao);
-        glDrawArrays(GL_POINTS, 0, static_cast<int>(m_pointCount));
+        for (const auto& chunk : m_chunks)
+        {
+            if (frustum)
+            {
+                BoundingBox box;
+                box.update(chunk.positionOffset);
+                box.update(chunk.positionOffset + chunk.positionScale);
+                if (!frustum->intersects(box.transform(model)))
+                {
+                    ++stats.chunksCulled;
+                    continue;
+                }
+            }
+            // maps the intensity of the chunk to the common range
+            const float intensityOffset =
+                intensityRange > 0.0f
+                    ? (chunk.intensityOffset - m_intensityMinimum) /
+                          intensityRange
+                    : 0.0f;
+            const float intensityScale =
+                intensityRange > 0.0f ? chunk.intensityScale / intensityRange
+                                      : 0.0f;
+            draw(chunk.positionOffset, chunk.positionScale, intensityOffset,
+                 intensityScale, chunk.first, chunk.count);
+        }
         glBindVertexArray(0);
     }
 
@@ -104,10 +216,24 @@ void PointCloud::configureShader()
                     m_singleColor.blueF()};
         glUniform3fv(location.value(), 1, rgb);
     }
+
 }
 
 void PointCloud::setPointCloudData(const PointCloudData& pointCloudData)
 {
+    reservePoints(pointCloudData.xyz.size(), !pointCloudData.rgba.empty(),
+                  !pointCloudData.normal.empty());
+    appendPointCloudData(pointCloudData);
+}
+
+void PointCloud::reservePoints(uint64_t pointCount, bool hasColor,
+                               bool hasNormal)
+{
+    if (pointCount > static_cast<uint64_t>(std::numeric_limits<GLint>::max()))
+    {
+        throw std::runtime_error("Too many points for a single point cloud.");
+    }
+
     if (m_vao < 0)
     {
         GLuint vao;
@@ -115,62 +241,269 @@ void PointCloud::setPointCloudData(const PointCloudData& pointCloudData)
         m_vao = vao;
     }
 
+    releaseNodes();
+    m_chunks.clear();
+    m_pointCount = 0;
+    m_capacity = pointCount;
+    m_rawIntensity = false;
+    m_intensityMinimum = 0.0f;
+    m_intensityMaximum = 1.0f;
+    m_boundingBox.reset();
+    m_bufferXYZ.reset();
+    m_bufferNormal.reset();
+    m_bufferRGBA.reset();
+    if (pointCount == 0)
+        return;
+
+    const auto count = static_cast<GLsizei>(pointCount);
     glBindVertexArray(m_vao);
 
-    if (!pointCloudData.xyz.empty())
+    // positions are stored as unsigned shorts relative to the bounding box of
+    // their chunk and dequantized by the vertex shader, the intensity shares
+    // the element as fourth component, so a point takes 8 bytes plus 4 for
+    // color
+    m_bufferXYZ = std::make_shared<OpenGLArrayBuffer>(
+        nullptr, GL_UNSIGNED_SHORT, 4, count, GL_STATIC_DRAW);
+    m_bufferXYZ->setVertexAttribute(0, true, 3, 0);
+    m_bufferXYZ->setVertexAttribute(2, true, 1, 3);
+
+    if (hasNormal)
     {
-        m_bufferXYZ = std::make_shared<OpenGLArrayBuffer>(
-            pointCloudData.xyz.data(), GL_FLOAT, 3, pointCloudData.xyz.size(),
-            GL_STATIC_DRAW);
-        glBindBuffer(GL_ARRAY_BUFFER, m_bufferXYZ->buffer());
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(GLfloat),
-                              (char*)0);
-        glEnableVertexAttribArray(0);
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-        m_pointCount = pointCloudData.xyz.size();
+        m_bufferNormal = std::make_shared<OpenGLArrayBuffer>(
+            nullptr, GL_FLOAT, 3, count, GL_STATIC_DRAW);
+        m_bufferNormal->setVertexAttribute(1);
+    }
 
-        m_boundingBox.reset();
-        for (const auto& point : pointCloudData.xyz)
+    if (hasColor)
+    {
+        m_bufferRGBA = std::make_shared<OpenGLArrayBuffer>(
+            nullptr, GL_UNSIGNED_BYTE, 4, count, GL_STATIC_DRAW);
+        m_bufferRGBA->setVertexAttribute(3, true);
+    }
+
+    glBindVertexArray(0);
+}
+
+void PointCloud::appendPointCloudData(const PointCloudData& chunk)
+{
+    const uint64_t count =
+        std::min<uint64_t>(chunk.xyz.size(), m_capacity - m_pointCount);
+    if (count == 0 || !m_bufferXYZ)
+        return;
+
+    const auto first = static_cast<GLint>(m_pointCount);
+    auto quantized = quantizePositions(chunk, 0, count);
+    m_bufferXYZ->setSubData(first, static_cast<GLsizei>(count),
+                            quantized.positions.data());
+    if (m_bufferNormal && !chunk.normal.empty())
+    {
+        m_bufferNormal->setSubData(first, static_cast<GLsizei>(count),
+                                   chunk.normal.data());
+    }
+    if (m_bufferRGBA && !chunk.rgba.empty())
+    {
+        m_bufferRGBA->setSubData(first, static_cast<GLsizei>(count),
+                                 chunk.rgba.data());
+    }
+
+    BoundingBox boundingBox;
+    boundingBox.update(quantized.offset);
+    boundingBox.update(quantized.offset + quantized.scale);
+    m_boundingBox = m_boundingBox.combine(boundingBox);
+
+    if (chunk.rawIntensity && !chunk.intensity.empty())
+    {
+        const float minimum = quantized.intensityOffset;
+        const float maximum = minimum + quantized.intensityScale;
+        m_intensityMinimum =
+            m_rawIntensity ? std::min(m_intensityMinimum, minimum) : minimum;
+        m_intensityMaximum =
+            m_rawIntensity ? std::max(m_intensityMaximum, maximum) : maximum;
+        m_rawIntensity = true;
+    }
+
+    m_chunks.push_back({first, static_cast<GLsizei>(count), quantized.offset,
+                        quantized.scale, quantized.intensityOffset,
+                        quantized.intensityScale});
+    m_pointCount += count;
+}
+
+void PointCloud::setNodeStore(PointCloudNodeStore::Ptr nodeStore)
+{
+    reservePoints(0, false);
+    m_nodeStore = std::move(nodeStore);
+    if (!m_nodeStore)
+        return;
+
+    if (m_nodeVao < 0)
+    {
+        GLuint vao;
+        glGenVertexArrays(1, &vao);
+        m_nodeVao = vao;
+    }
+    m_pointCount = m_nodeStore->pointCount();
+    m_boundingBox = m_nodeStore->boundingBox();
+
+    // nodes are read in the background, the view is redrawn once they are
+    // there
+    if (auto* nodeScene = scene())
+    {
+        m_nodeStore->setLoadedCallback([nodeScene]()
+                                       { emit nodeScene->update(); });
+    }
+}
+
+void PointCloud::selectNodes(Scene& scene, const Camera& camera)
+{
+    struct Candidate
+    {
+        // projected node radius in pixels
+        float priority;
+        // pixels per unit at the node distance
+        float scale;
+        size_t pointCloud;
+        uint32_t node;
+
+        bool operator<(const Candidate& other) const
         {
-            m_boundingBox.update(Vector3d(point[0], point[1], point[2]));
+            return priority < other.priority;
         }
-    }
+    };
+
+    auto& cache = scene.bufferCache();
+    auto& stats = scene.renderStats();
+    const auto frustum =
+        Frustum::fromMatrix(camera.projection() * camera.view());
+    std::vector<std::pair<PointCloud*, Matrix4d>> pointClouds;
+    std::priority_queue<Candidate> candidates;
 
-    if (!pointCloudData.normal.empty())
+    // nodes outside of the frustum or below a pixel are dropped together
+    // with their subtree
+    auto push = [&](size_t pointCloud, uint32_t index)
     {
-        m_bufferNormal = std::make_shared<OpenGLArrayBuffer>(
-            pointCloudData.normal.data(), GL_FLOAT, 3,
-            pointCloudData.normal.size(), GL_STATIC_DRAW);
-        glBindBuffer(GL_ARRAY_BUFFER, m_bufferNormal->buffer());
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(GLfloat),
-                              (char*)0);
-        glEnableVertexAttribArray(1);
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        const auto& [cloud, model] = pointClouds[pointCloud];
+        const auto& node = cloud->m_nodeStore->nodes()[index];
+        BoundingBox box;
+        box.update(node.center - Vector3d(node.halfSize));
+        box.update(node.center + Vector3d(node.halfSize));
+        box = box.transform(model);
+
+        const Vector3d extents = Vector3d(box.max) - Vector3d(box.min);
+        const float radius = VectorLength(extents) * 0.5f;
+        const float size = camera.projectedSize(
+            Vector3d(box.min) + extents * 0.5f, radius);
+        if (scene.culling() && (!frustum.intersects(box) ||
+                                size < Scene::MIN_PROJECTED_SIZE))
+        {
+            ++stats.chunksCulled;
+            return;
+        }
+        // nodes around the camera are always refined
+        const float scale = size / (2.0f * radius);
+        candidates.push({size * 0.5f, scale, pointCloud, index});
+    };
+
+    uint64_t pointCount = 0;
+    for (const auto& sceneNode : scene.nodes())
+    {
+        auto* cloud = dynamic_cast<PointCloud*>(sceneNode.get());
+        if (!cloud)
+            continue;
+
+        cloud->m_visibleNodes.clear();
+        if (!cloud->m_nodeStore)
+        {
+            pointCount += cloud->visible() ? cloud->m_pointCount : 0;
+            continue;
+        }
+
+        // nodes read in the background are uploaded first
+        for (auto& [node, data] : cloud->m_nodeStore->takeLoaded())
+        {
+            const uint64_t key = cloud->nodeKey(node);
+            if (cache.contains(key))
+                continue;
+            auto buffer = std::make_shared<OpenGLArrayBuffer>(
+                data.data(), GL_UNSIGNED_BYTE, 1,
+                static_cast<GLsizei>(data.size()), GL_STATIC_DRAW);
+            cache.addItem(key, Scene::BufferCache::CacheItemType(
+                                   std::move(buffer), data.size()));
+        }
+
+        cloud->m_requestedNodes.clear();
+        if (!cloud->visible())
+        {
+            cloud->m_nodeStore->request({});
+            continue;
+        }
+        pointClouds.emplace_back(cloud, cloud->modelMatrix());
+        push(pointClouds.size() - 1, 0);
     }
 
-    if (!pointCloudData.intensity.empty())
+    // the selection has to fit into the cache, otherwise its nodes would
+    // evict each other
+    const uint64_t pointBudget = scene.pointBudget();
+    const uint64_t byteBudget = cache.capacity() / 2;
+    uint64_t byteCount = 0;
+    while (!candidates.empty())
     {
-        m_bufferIntensity = std::make_shared<OpenGLArrayBuffer>(
-            pointCloudData.intensity.data(), GL_FLOAT, 1,
-            pointCloudData.intensity.size(), GL_STATIC_DRAW);
-        glBindBuffer(GL_ARRAY_BUFFER, m_bufferIntensity->buffer());
-        glVertexAttribPointer(2, 1, GL_FLOAT, GL_FALSE, 1 * sizeof(GLfloat),
-                              (char*)0);
-        glEnableVertexAttribArray(2);
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        const Candidate candidate = candidates.top();
+        candidates.pop();
+        auto* cloud = pointClouds[candidate.pointCloud].first;
+        const auto& node = cloud->m_nodeStore->nodes()[candidate.node];
+        const uint64_t nodeBytes =
+            cloud->m_nodeStore->nodeByteSize(candidate.node);
+        if (pointCount + node.count > pointBudget ||
+            byteCount + nodeBytes > byteBudget)
+            break;
+
+        pointCount += node.count;
+        byteCount += nodeBytes;
+        const uint64_t key = cloud->nodeKey(candidate.node);
+        if (!cache.contains(key))
+        {
+            // children are refined once their parent is there
+            cloud->m_requestedNodes.push_back(candidate.node);
+            continue;
+        }
+
+        cache.update(key);
+        cloud->m_visibleNodes.push_back(candidate.node);
+        if (node.spacing * candidate.scale <=
+            static_cast<float>(cloud->m_pointSize))
+            continue;
+
+        for (auto child : node.children)
+        {
+            if (child != 0)
+            {
+                push(candidate.pointCloud, child);
+            }
+        }
     }
 
-    if (!pointCloudData.rgba.empty())
+    for (const auto& [cloud, model] : pointClouds)
     {
-        m_bufferRGBA = std::make_shared<OpenGLArrayBuffer>(
-            pointCloudData.rgba.data(), GL_FLOAT, 4, pointCloudData.rgba.size(),
-            GL_STATIC_DRAW);
-        glBindBuffer(GL_ARRAY_BUFFER, m_bufferRGBA->buffer());
-        glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(GLfloat),
-                              (char*)0);
-        glEnableVertexAttribArray(3);
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        cloud->m_nodeStore->request(cloud->m_requestedNodes);
     }
+}
 
-    glBindVertexArray(0);
+uint64_t PointCloud::nodeKey(uint32_t node) const
+{
+    return (uint64_t{id()} << 32) | node;
+}
+
+void PointCloud::releaseNodes()
+{
+    if (m_nodeStore && scene())
+    {
+        auto& cache = scene()->bufferCache();
+        for (uint32_t node = 0; node < m_nodeStore->nodes().size(); ++node)
+        {
+            cache.removeItem(nodeKey(node));
+        }
+    }
+    m_nodeStore.reset();
+    m_visibleNodes.clear();
+    m_requestedNodes.clear();
 }
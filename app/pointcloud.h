@@ -10,6 +10,9 @@
 #include <vector>
 
 #include "E57Utils.h"
+#include "PointCloudNodeStore.h"
+
+class Camera;
 
 enum class PointCloudViewType
 {
@@ -40,8 +43,54 @@ public:
     [[nodiscard]] bool visible() const { return m_visible; }
     void setVisible(bool visible) { m_visible = visible; }
 
+    /**
+     * How the scan is subsampled while loading, maxPoints is the share of the
+     * load budget of the scene the point cloud was loaded with.
+     */
+    [[nodiscard]] const SamplingOptions& sampling() const { return m_sampling; }
+    void setSampling(const SamplingOptions& sampling)
+    {
+        m_sampling = sampling;
+    }
+
     void setPointCloudData(const PointCloudData& pointCloudData);
 
+    /**
+     * Allocates the buffers for up to the given number of points, which are
+     * then filled by appendPointCloudData. Previously uploaded points and
+     * nodes are discarded.
+     */
+    void reservePoints(uint64_t pointCount, bool hasColor,
+                       bool hasNormal = false);
+
+    /**
+     * Uploads a chunk of points behind the previously uploaded ones, it is
+     * drawn from the next frame on. Points beyond the reserved size are
+     * dropped. Chunks with raw intensity are all normalized by the range of
+     * the chunks uploaded so far.
+     */
+    void appendPointCloudData(const PointCloudData& chunk);
+
+    /**
+     * Replaces the uploaded points by the octree nodes of the scan. From then
+     * on the nodes chosen by selectNodes are drawn, they are read from the
+     * store on demand and kept in the buffer cache of the scene.
+     */
+    void setNodeStore(PointCloudNodeStore::Ptr nodeStore);
+
+    /**
+     * Chooses the octree nodes drawn in the next frame for all point clouds
+     * of the scene. Nodes are taken by projected size, largest first, until
+     * the point budget of the scene or half of its buffer cache is used up.
+     * A node is only refined while its points are more than a point size
+     * apart on screen. Nodes which are not in the cache are requested from
+     * their store and drawn once they arrive. Point clouds without nodes are
+     * drawn completely and count against the budget.
+     */
+    static void selectNodes(Scene& scene, const Camera& camera);
+
+    [[nodiscard]] uint64_t pointCount() const { return m_pointCount; }
+
     [[nodiscard]] const E57Data3D& data3D() const { return *m_data3D; }
 
 private:
@@ -50,13 +99,45 @@ private:
     PointCloudViewType m_viewType{PointCloudViewType::COLOR};
     QColor m_singleColor;
     bool m_visible{true};
+    SamplingOptions m_sampling{.mode = SamplingMode::UNIFORM};
     Shader::Ptr m_shader;
     Shader::Ptr m_lineShader;
 
+    /**
+     * Range of points uploaded together, drawn with its own dequantization:
+     * position = positionOffset + positionScale * normalized position, and
+     * likewise for the intensity.
+     */
+    struct Chunk
+    {
+        GLint first;
+        GLsizei count;
+        Vector3d positionOffset;
+        Vector3d positionScale;
+        float intensityOffset;
+        float intensityScale;
+    };
+
+    // positions and intensity
     OpenGLArrayBuffer::Ptr m_bufferXYZ;
     OpenGLArrayBuffer::Ptr m_bufferNormal;
-    OpenGLArrayBuffer::Ptr m_bufferIntensity;
     OpenGLArrayBuffer::Ptr m_bufferRGBA;
+    std::vector<Chunk> m_chunks;
+    uint64_t m_capacity{0};
+    // raw intensity of all chunks is normalized by the range of the chunks
+    // uploaded so far
+    bool m_rawIntensity{false};
+    float m_intensityMinimum{0.0f};
+    float m_intensityMaximum{1.0f};
+
+    PointCloudNodeStore::Ptr m_nodeStore;
+    std::vector<uint32_t> m_visibleNodes;
+    std::vector<uint32_t> m_requestedNodes;
+    // vertex array for the node buffers, which are bound per draw
+    int64_t m_nodeVao{-1};
+
+    [[nodiscard]] uint64_t nodeKey(uint32_t node) const;
+    void releaseNodes();
 
     int64_t m_vao{-1};
     uint64_t m_pointCount{0};
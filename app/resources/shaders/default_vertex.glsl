@@ -13,10 +13,18 @@ uniform mat4 projection;
 uniform int  pointSize;
 uniform int  viewType;
 uniform vec3 singleColor;
+// positions are quantized relative to the bounding box
+uniform vec3 positionOffset;
+uniform vec3 positionScale;
+// intensity is quantized relative to its range and normalized by the offset
+// and scale
+uniform float intensityOffset;
+uniform float intensityScale;
 
 void main()
 {
-    gl_Position = projection * view * model * vec4(in_vtx_xyz, 1.0);
+    vec3 xyz = positionOffset + positionScale * in_vtx_xyz;
+    gl_Position = projection * view * model * vec4(xyz, 1.0);
     gl_PointSize = pointSize;
 
     if (viewType == 0)
@@ -25,7 +33,9 @@ void main()
     }
     else if (viewType == 1)
     {
-        var_vtx_rgb = vec3(in_vtx_intensity, in_vtx_intensity, in_vtx_intensity);
+        float intensity = intensityOffset + intensityScale * in_vtx_intensity;
+        intensity = clamp(intensity, 0.0, 1.0);
+        var_vtx_rgb = vec3(intensity, intensity, intensity);
     }
     else
     {
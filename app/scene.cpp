@@ -1,23 +1,50 @@
 #include "scene.h"
+#include "camera.h"
+#include "frustum.h"
 
 #include <queue>
 #include <tuple>
 
-Scene::Scene() : m_bufferCache(1024) {}
+Scene::Scene() : m_bufferCache(DEFAULT_BUFFER_CACHE_SIZE) {}
 
 void Scene::render()
 {
-    for (auto& child : m_nodes)
+    // the camera matrices are up to date, the camera renders first
+    auto* camera = findNode<Camera>();
+    std::optional<Frustum> frustum;
+    if (camera && m_culling)
     {
-        if (!child->transparent())
-        {
-            child->render();
-        }
+        frustum = Frustum::fromMatrix(camera->projection() * camera->view());
     }
-    for (auto& child : m_nodes)
+
+    // nodes without extent, like the camera, are always rendered
+    auto isVisible = [&](const SceneNode& node)
+    {
+        auto box = node.boundingBox();
+        if (!frustum || !box.isValid())
+            return true;
+
+        box = box.transform(node.modelMatrix());
+        if (!frustum->intersects(box))
+            return false;
+        const Vector3d extents = Vector3d(box.max) - Vector3d(box.min);
+        const Vector3d center = Vector3d(box.min) + extents * 0.5f;
+        return camera->projectedSize(center, VectorLength(extents) * 0.5f) >=
+               MIN_PROJECTED_SIZE;
+    };
+
+    for (bool transparent : {false, true})
     {
-        if (child->transparent())
+        for (auto& child : m_nodes)
         {
+            if (child->transparent() != transparent)
+                continue;
+            if (!isVisible(*child))
+            {
+                ++m_renderStats.nodesCulled;
+                continue;
+            }
+            ++m_renderStats.nodesRendered;
             child->render();
         }
     }
@@ -29,6 +56,23 @@ void Scene::render2D(QPainter& painter)
     {
         child->render2D(painter);
     }
+
+    if (m_showRenderStats)
+    {
+        const auto& stats = m_renderStats;
+        const QString text =
+            QString("Nodes: %1 rendered, %2 culled\n"
+                    "Chunks: %3 rendered, %4 culled\n"
+                    "Points: %5")
+                .arg(stats.nodesRendered)
+                .arg(stats.nodesCulled)
+                .arg(stats.chunksRendered)
+                .arg(stats.chunksCulled)
+                .arg(stats.pointsRendered);
+        painter.setPen(Qt::white);
+        painter.drawText(QRect(10, 10, 400, 60),
+                         Qt::AlignLeft | Qt::AlignTop, text);
+    }
 }
 
 SceneNode::SceneNode(SceneNode* parent) : m_parent{parent}
@@ -60,7 +60,7 @@ protected:
     uint32_t m_id;
     std::string m_name;
     std::vector<Ptr> m_childNodes;
-    Scene* m_scene;
+    Scene* m_scene{nullptr};
     SceneNode* m_parent{nullptr};
     BoundingBox m_boundingBox{};
     bool m_transparent{false};
@@ -76,8 +76,28 @@ class Scene : public QObject
     Q_OBJECT
 public:
     using Ptr = std::shared_ptr<Scene>;
+    // GPU buffers by key, the size of an item is its size in bytes
     using BufferCache =
-        SiLRUCache<uint32_t, std::shared_ptr<OpenGLArrayBuffer>, size_t>;
+        SiLRUCache<uint64_t, std::shared_ptr<OpenGLArrayBuffer>, size_t>;
+
+    static constexpr uint64_t DEFAULT_POINT_BUDGET = 10000000;
+    static constexpr uint64_t DEFAULT_LOAD_BUDGET = 100000000;
+    static constexpr size_t DEFAULT_BUFFER_CACHE_SIZE = size_t{1} << 30;
+    // nodes smaller than this on screen are culled, in pixels
+    static constexpr float MIN_PROJECTED_SIZE = 1.0f;
+
+    /**
+     * What the last frame drew and culled. Nodes are the scene nodes, chunks
+     * the point ranges and octree nodes of the point clouds.
+     */
+    struct RenderStats
+    {
+        uint32_t nodesRendered{0};
+        uint32_t nodesCulled{0};
+        uint32_t chunksRendered{0};
+        uint32_t chunksCulled{0};
+        uint64_t pointsRendered{0};
+    };
 
     Scene();
     void render();
@@ -88,6 +108,37 @@ public:
     bool invokeAgain() const { return m_invokeAgain; }
     void setInvokeAgain(bool invokeAgain) { m_invokeAgain = invokeAgain; }
     
+    /**
+     * Points drawn per frame at most by all point clouds with level of
+     * detail together.
+     */
+    [[nodiscard]] uint64_t pointBudget() const { return m_pointBudget; }
+    void setPointBudget(uint64_t pointBudget) { m_pointBudget = pointBudget; }
+
+    /**
+     * Points loaded at most by all subsampled point clouds together, each
+     * scan gets what the scans loaded before have left.
+     */
+    [[nodiscard]] uint64_t loadBudget() const { return m_loadBudget; }
+    void setLoadBudget(uint64_t loadBudget) { m_loadBudget = loadBudget; }
+
+    /**
+     * Scene nodes outside of the camera frustum or smaller than
+     * MIN_PROJECTED_SIZE are not rendered.
+     */
+    [[nodiscard]] bool culling() const { return m_culling; }
+    void setCulling(bool culling) { m_culling = culling; }
+
+    [[nodiscard]] RenderStats& renderStats() { return m_renderStats; }
+    [[nodiscard]] const RenderStats& renderStats() const
+    {
+        return m_renderStats;
+    }
+    void resetRenderStats() { m_renderStats = {}; }
+
+    [[nodiscard]] bool showRenderStats() const { return m_showRenderStats; }
+    void setShowRenderStats(bool value) { m_showRenderStats = value; }
+
     [[nodiscard]] BufferCache& bufferCache();
     [[nodiscard]] const BufferCache& bufferCache() const;
 
@@ -116,6 +167,11 @@ public:
 
 signals:
     void update();
+    /**
+     * The settings of a node were changed in a way that requires to load it
+     * again.
+     */
+    void reloadRequested(SceneNode* node);
 
 private:
     BufferCache m_bufferCache;
@@ -123,6 +179,11 @@ private:
     Matrix4d m_pose{IdentityMatrix4d};
 
     bool m_invokeAgain{false};
+    uint64_t m_pointBudget{DEFAULT_POINT_BUDGET};
+    uint64_t m_loadBudget{DEFAULT_LOAD_BUDGET};
+    bool m_culling{true};
+    RenderStats m_renderStats;
+    bool m_showRenderStats{false};
 
     float m_devicePixelRatio{1.0};
 };
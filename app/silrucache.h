@@ -25,11 +25,11 @@ SOFTWARE.
 #ifndef SILRUCACHE_H
 #define SILRUCACHE_H
 
-#include <vector>
-#include <unordered_map>
 #include <cstdint>
-#include <algorithm>
+#include <functional>
 #include <stdexcept>
+#include <unordered_map>
+#include <utility>
 
 template <typename Value, typename Size = uint32_t, Size defaultSize = 1>
 class SiLRUCacheItem {
@@ -46,11 +46,11 @@ public:
     {}
 
     SiLRUCacheItem(Value&& val, Size size) 
-        : m_value{val}, m_size{size}
+        : m_size{size}, m_value{std::move(val)}
     {}
 
     SiLRUCacheItem(const Value& val, Size size) 
-        : m_value{val}, m_size{size}
+        : m_size{size}, m_value{val}
     {}
 
     Size size() const {
@@ -78,15 +78,32 @@ private:
     Value m_value{};
 };
 
+/**
+ * @brief Least-recently-used cache with a size budget.
+ *
+ * The entries are linked into a doubly-linked recency list through pointers
+ * stored next to them in the hash map, which keeps its elements in place on
+ * rehashing. Insertion, lookup, update, removal and eviction of an entry are
+ * constant time on average, the total size is kept up to date on every
+ * change.
+ */
 template <typename Key, typename Value, typename Size = uint32_t, Size defaultSize = 1>
 class SiLRUCache {
 public:
     using CacheItemType = SiLRUCacheItem<Value, Size, defaultSize>;
+    /**
+     * @brief Called with each item evicted to make room, before it is
+     * destroyed.
+     */
+    using EvictionCallback = std::function<void(const Key&, CacheItemType&)>;
 
     SiLRUCache(Size cacheSize)
-        : m_cacheSize(cacheSize), m_queue(0)
+        : m_cacheSize(cacheSize)
     {}
 
+    SiLRUCache(const SiLRUCache&) = delete;
+    SiLRUCache& operator=(const SiLRUCache&) = delete;
+
     /**
      * @brief Adds a new item into the cache.
      * 
@@ -94,9 +111,7 @@ public:
      * @param value Cache Value
      */
     void addItem(const Key& key, const Value& value) {
-        checkQueueSize(defaultSize);
-        m_cacheItems.emplace(key, value);
-        updateQueue(key);
+        insert(key, CacheItemType(value));
     }
 
     /**
@@ -106,9 +121,7 @@ public:
      * @param value Cache Value
      */
     void addItem(const Key& key, Value&& value) {
-        checkQueueSize(defaultSize);
-        m_cacheItems.emplace(key, std::move(value));
-        updateQueue(key);
+        insert(key, CacheItemType(std::move(value)));
     }
 
     /**
@@ -118,9 +131,7 @@ public:
      * @param value Cache Value
      */
     void addItem(const Key& key, const CacheItemType& value) {
-        checkQueueSize(value.size());
-        m_cacheItems.emplace(key, value);
-        updateQueue(key);
+        insert(key, CacheItemType(value));
     }
 
     /**
@@ -130,20 +141,19 @@ public:
      * @param value Cache Value
      */
     void addItem(const Key& key, CacheItemType&& value) {
-        checkQueueSize(value.size());
-        m_cacheItems.emplace(key, std::move(value));
-        updateQueue(key);
+        insert(key, std::move(value));
     }
 
     /**
      * @brief Removes the cache item with the specified key from the cache.
+     * The eviction callback is not called.
      * 
      * @param key Cache Key
      */
     void removeItem(const Key& key) {
-        if (!contains(key)) return;
-        m_cacheItems.erase(key);
-        removeFromQueue(key);
+        auto it = m_cacheItems.find(key);
+        if (it == m_cacheItems.end()) return;
+        erase(it);
     }
 
     /**
@@ -153,30 +163,33 @@ public:
      * @return true If the key is contained in the cache.
      * @return false If the key is not contained in the cache.
      */
-    bool contains(const Key& key) {
+    bool contains(const Key& key) const {
         return m_cacheItems.find(key) != m_cacheItems.end();
     }
 
     /**
-     * @brief Retrieve the item from the cache.
+     * @brief Retrieve the item from the cache and mark it as most recently
+     * used.
      * 
      * @param key Key of the cache item.
-     * @return Value* Pointer to the value.
+     * @return Reference to the item, std::out_of_range is thrown if the key
+     * is not in the cache.
      */
-    auto& getItem(const Key& key) {
-        updateQueue(key);
-        return m_cacheItems.at(key);
+    CacheItemType& getItem(const Key& key) {
+        auto& entry = find(key);
+        touch(entry);
+        return entry.item;
     }
 
     /**
-     * @brief Retrieve the item from the cache.
+     * @brief Retrieve the item from the cache without changing its recency.
      * 
      * @param key Key of the cache item.
-     * @return Value* Pointer to the value.
+     * @return Reference to the item, std::out_of_range is thrown if the key
+     * is not in the cache.
      */
-    const auto& getItem(const Key& key) const {
-        updateQueue(key);
-        return m_cacheItems.at(key);
+    const CacheItemType& getItem(const Key& key) const {
+        return m_cacheItems.at(key).item;
     }
 
     /**
@@ -185,16 +198,40 @@ public:
      * @param key Key of the cache item.
      */
     void update(const Key& key) {
-        updateQueue(key);
+        auto it = m_cacheItems.find(key);
+        if (it != m_cacheItems.end()) {
+            touch(it->second);
+        }
     }
 
     /**
-     * @brief Reset the cache. Destroys all cache items.
+     * @brief Reset the cache. Destroys all cache items without calling the
+     * eviction callback.
      * 
      */
     void reset() {
-        m_queue.clear();
         m_cacheItems.clear();
+        m_oldest = nullptr;
+        m_newest = nullptr;
+        m_size = Size{};
+    }
+
+    /**
+     * @brief Sets the function called for every item evicted to make room.
+     *
+     * @param callback Eviction callback, may be empty.
+     */
+    void setEvictionCallback(EvictionCallback callback) {
+        m_evictionCallback = std::move(callback);
+    }
+
+    /**
+     * @brief Returns the maximum total size of the cache items.
+     * 
+     * @return Size 
+     */
+    Size capacity() const {
+        return m_cacheSize;
     }
 
     /**
@@ -203,38 +240,102 @@ public:
      * @return Size 
      */
     Size size() const {
-        Size totalSize{};
-        for (const auto& [key, value] : m_cacheItems) {
-            totalSize += value.size();
-        }
-        return totalSize;
+        return m_size;
+    }
+
+    /**
+     * @brief Returns the number of items inside the cache.
+     */
+    size_t count() const {
+        return m_cacheItems.size();
     }
 
 private:
+    struct Entry {
+        CacheItemType item;
+        // neighbours in the recency list, towards the oldest and the newest
+        Entry* older{nullptr};
+        Entry* newer{nullptr};
+        const Key* key{nullptr};
+    };
+
     const Size m_cacheSize;
-    std::vector<Key> m_queue;
-    std::unordered_map<Key, CacheItemType> m_cacheItems;
+    Size m_size{};
+    std::unordered_map<Key, Entry> m_cacheItems;
+    Entry* m_oldest{nullptr};
+    Entry* m_newest{nullptr};
+    EvictionCallback m_evictionCallback;
+
+    Entry& find(const Key& key) {
+        auto it = m_cacheItems.find(key);
+        if (it == m_cacheItems.end()) {
+            throw std::out_of_range("Key not in cache.");
+        }
+        return it->second;
+    }
 
-    void updateQueue(const Key& key) {
-        if (m_queue.size() > 0 && m_queue.back() == key) return;
-        removeFromQueue(key);
-        m_queue.push_back(key);
+    void insert(const Key& key, CacheItemType&& value) {
+        // a replaced item does not count against the new one
+        removeItem(key);
+        makeRoom(value.size());
+
+        auto it = m_cacheItems.emplace(key, Entry{std::move(value)}).first;
+        auto& entry = it->second;
+        entry.key = &it->first;
+        m_size += entry.item.size();
+        link(entry);
     }
 
-    void checkQueueSize(Size requestedSize) {
-        while (size() + requestedSize > m_cacheSize) {
-            if  (m_queue.empty()) {
-                throw std::runtime_error("Cache too small.");
+    void makeRoom(Size requestedSize) {
+        if (requestedSize > m_cacheSize) {
+            throw std::runtime_error("Cache too small.");
+        }
+        while (m_oldest && m_size + requestedSize > m_cacheSize) {
+            auto it = m_cacheItems.find(*m_oldest->key);
+            if (m_evictionCallback) {
+                m_evictionCallback(it->first, it->second.item);
             }
-            m_cacheItems.erase(m_queue.front());
-            m_queue.erase(m_queue.begin(), m_queue.begin() + 1);
+            erase(it);
         }
     }
 
-    void removeFromQueue(const Key& key) {
-        std::remove_if(m_queue.begin(), m_queue.end(), [&key](const auto& k) {
-            return k == key;
-        });
+    void erase(typename std::unordered_map<Key, Entry>::iterator it) {
+        unlink(it->second);
+        m_size -= it->second.item.size();
+        m_cacheItems.erase(it);
+    }
+
+    void touch(Entry& entry) {
+        if (&entry == m_newest) return;
+        unlink(entry);
+        link(entry);
+    }
+
+    // appends the entry as the newest one
+    void link(Entry& entry) {
+        entry.older = m_newest;
+        entry.newer = nullptr;
+        if (m_newest) {
+            m_newest->newer = &entry;
+        } else {
+            m_oldest = &entry;
+        }
+        m_newest = &entry;
+    }
+
+    void unlink(Entry& entry) {
+        if (entry.older) {
+            entry.older->newer = entry.newer;
+        } else {
+            m_oldest = entry.newer;
+        }
+        if (entry.newer) {
+            entry.newer->older = entry.older;
+        } else {
+            m_newest = entry.older;
+        }
+        entry.older = nullptr;
+        entry.newer = nullptr;
     }
 };
 
@@ -0,0 +1,148 @@
+#ifndef E57INSPECTOR_BENCHMARK_H
+#define E57INSPECTOR_BENCHMARK_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * Amount of work done by one run of a benchmark, used to derive
+ * throughput.
+ */
+struct Work
+{
+    uint64_t items{0};
+    uint64_t bytes{0};
+};
+
+struct BenchmarkResult
+{
+    std::string file;
+    std::string benchmark;
+    std::string variant;
+    std::vector<double> seconds;
+    Work work;
+    // additional named values, e.g. the error of a kernel
+    std::vector<std::pair<std::string, double>> metrics;
+};
+
+/**
+ * Runs the function the given number of times and records the wall time of
+ * every run. The work reported by the last run is kept.
+ */
+inline BenchmarkResult measure(const std::string& file,
+                               const std::string& benchmark,
+                               const std::string& variant, int iterations,
+                               const std::function<Work()>& function)
+{
+    BenchmarkResult result{file, benchmark, variant, {}, {}, {}};
+    for (int i = 0; i < iterations; ++i)
+    {
+        auto start = std::chrono::steady_clock::now();
+        result.work = function();
+        auto end = std::chrono::steady_clock::now();
+        result.seconds.push_back(
+            std::chrono::duration<double>(end - start).count());
+    }
+    return result;
+}
+
+inline std::string jsonString(const std::string& value)
+{
+    std::string result = "\"";
+    for (char c : value)
+    {
+        switch (c)
+        {
+        case '"':
+            result += "\\\"";
+            break;
+        case '\\':
+            result += "\\\\";
+            break;
+        case '\n':
+            result += "\\n";
+            break;
+        case '\t':
+            result += "\\t";
+            break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20)
+            {
+                char escaped[8];
+                std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                result += escaped;
+            }
+            else
+            {
+                result += c;
+            }
+        }
+    }
+    return result + "\"";
+}
+
+/**
+ * Writes the results as a JSON document. Times are in seconds, throughput
+ * is derived from the median time.
+ */
+inline void writeJson(std::ostream& os, const std::string& version,
+                      int iterations,
+                      const std::vector<BenchmarkResult>& results)
+{
+    os << "{\n";
+    os << "  \"version\": " << jsonString(version) << ",\n";
+    os << "  \"iterations\": " << iterations << ",\n";
+    os << "  \"results\": [";
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const auto& result = results[i];
+        auto seconds = result.seconds;
+        std::sort(seconds.begin(), seconds.end());
+        double min = seconds.empty() ? 0.0 : seconds.front();
+        double median = seconds.empty() ? 0.0 : seconds[seconds.size() / 2];
+        double mean = 0.0;
+        for (double s : seconds)
+        {
+            mean += s / static_cast<double>(seconds.size());
+        }
+
+        os << (i == 0 ? "\n" : ",\n");
+        os << "    {\n";
+        os << "      \"file\": " << jsonString(result.file) << ",\n";
+        os << "      \"benchmark\": " << jsonString(result.benchmark)
+           << ",\n";
+        os << "      \"variant\": " << jsonString(result.variant) << ",\n";
+        os << "      \"seconds\": {\"min\": " << min
+           << ", \"median\": " << median << ", \"mean\": " << mean << "},\n";
+        os << "      \"items\": " << result.work.items << ",\n";
+        os << "      \"bytes\": " << result.work.bytes << ",\n";
+        os << "      \"itemsPerSecond\": "
+           << (median > 0.0 ? result.work.items / median : 0.0) << ",\n";
+        os << "      \"bytesPerSecond\": "
+           << (median > 0.0 ? result.work.bytes / median : 0.0);
+        if (!result.metrics.empty())
+        {
+            os << ",\n      \"metrics\": {";
+            for (size_t j = 0; j < result.metrics.size(); ++j)
+            {
+                os << (j == 0 ? "" : ", ")
+                   << jsonString(result.metrics[j].first) << ": "
+                   << result.metrics[j].second;
+            }
+            os << "}";
+        }
+        os << "\n";
+        os << "    }";
+    }
+    os << "\n  ]\n";
+    os << "}\n";
+}
+
+#endif // E57INSPECTOR_BENCHMARK_H
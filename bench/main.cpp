@@ -0,0 +1,513 @@
+#include "E57Utils.h"
+#include "benchmark.h"
+#include "panorama.h"
+#include "silrucache.h"
+
+#include <e57inspector/E57BlobStream.h>
+#include <e57inspector/E57Reader.h>
+#include <e57inspector/E57Spherical.h>
+
+#include <cmath>
+#include <iostream>
+#include <optional>
+#include <random>
+#include <set>
+
+struct Options
+{
+    int iterations{3};
+    uint64_t maxPoints{0};
+    uint32_t batchSize{10000};
+    size_t chunkSize{E57BlobStream::DEFAULT_CHUNK_SIZE};
+    bool index{false};
+    uint64_t kernelPoints{10000000};
+    std::string filter;
+    std::vector<std::string> files;
+};
+
+void printHelp(const std::string& exePath)
+{
+    std::cout
+        << "Usage: " << exePath << " [OPTIONS] [E57_FILE...]\n\n"
+        << "Measures the reader, panorama and point loading hot paths and\n"
+        << "writes the results as JSON to stdout. Without E57 files only the\n"
+        << "kernel benchmarks run.\n\n"
+        << "Options:\n"
+        << "  --iterations N   Runs per benchmark (default 3)\n"
+        << "  --max-points N   Records read per scan by the read benchmark,\n"
+        << "                   0 for all (default 0)\n"
+        << "  --batch-size N   Records per read call (default 10000)\n"
+        << "  --chunk-size N   Bytes per blob stream chunk (default 1 MiB)\n"
+        << "  --index          Also measure opening from the sidecar index,\n"
+        << "                   panoramas are created from it then.\n"
+        << "                   Writes <E57_FILE>.e57idx.\n"
+        << "  --kernel-points N\n"
+        << "                   Points per kernel benchmark run\n"
+        << "                   (default 10000000)\n"
+        << "  --filter NAME    Only run benchmarks whose name contains NAME\n"
+        << "                   (sphericalToCartesian, open, dumpXML, blob,\n"
+        << "                   lruCache, read, createPanorama, getData3D)"
+        << std::endl;
+}
+
+std::optional<Options> parseArguments(int argc, char* argv[])
+{
+    Options options;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg(argv[i]);
+        auto value = [&]() -> std::string
+        {
+            if (i + 1 >= argc)
+            {
+                throw std::runtime_error("Missing value for " + arg + ".");
+            }
+            return argv[++i];
+        };
+
+        if (arg == "--iterations")
+            options.iterations = std::max(1, std::stoi(value()));
+        else if (arg == "--max-points")
+            options.maxPoints = std::stoull(value());
+        else if (arg == "--batch-size")
+            options.batchSize = std::max(1ul, std::stoul(value()));
+        else if (arg == "--chunk-size")
+            options.chunkSize = std::max(1ull, std::stoull(value()));
+        else if (arg == "--index")
+            options.index = true;
+        else if (arg == "--kernel-points")
+            options.kernelPoints = std::max(1ull, std::stoull(value()));
+        else if (arg == "--filter")
+            options.filter = value();
+        else if (arg == "--help" || arg == "-h")
+            return std::nullopt;
+        else if (arg.starts_with("--"))
+            throw std::runtime_error("Unknown option " + arg + ".");
+        else
+            options.files.push_back(arg);
+    }
+
+    if (argc < 2)
+    {
+        return std::nullopt;
+    }
+    return options;
+}
+
+bool isEnabled(const Options& options, const std::string& benchmark)
+{
+    return options.filter.empty() ||
+           benchmark.find(options.filter) != std::string::npos;
+}
+
+/**
+ * Measures the spherical to cartesian kernel against the standard library
+ * on random coordinates. Its accuracy is checked by the tests of the library.
+ */
+void benchmarkKernels(const Options& options,
+                      std::vector<BenchmarkResult>& results)
+{
+    if (!isEnabled(options, "sphericalToCartesian"))
+        return;
+
+    const auto size = static_cast<size_t>(options.kernelPoints);
+    std::vector<float> range(size);
+    std::vector<float> elevation(size);
+    std::vector<float> azimuth(size);
+    std::mt19937 random(1);
+    std::uniform_real_distribution<float> rangeDistribution(0.1f, 100.0f);
+    std::uniform_real_distribution<float> elevationDistribution(
+        -M_PI / 2.0, M_PI / 2.0);
+    std::uniform_real_distribution<float> azimuthDistribution(-M_PI, M_PI);
+    for (size_t i = 0; i < size; ++i)
+    {
+        range[i] = rangeDistribution(random);
+        elevation[i] = elevationDistribution(random);
+        azimuth[i] = azimuthDistribution(random);
+    }
+
+    std::vector<std::array<float, 3>> xyz(size);
+    const Work work{size, size * 6 * sizeof(float)};
+
+    std::cerr << "sphericalToCartesian" << std::endl;
+    results.push_back(measure("", "sphericalToCartesian",
+                              sphericalToCartesianInstructionSet(),
+                              options.iterations,
+                              [&]()
+                              {
+                                  sphericalToCartesian(range, elevation,
+                                                       azimuth, xyz);
+                                  return work;
+                              }));
+
+    results.push_back(measure("", "sphericalToCartesian", "std",
+                              options.iterations,
+                              [&]()
+                              {
+                                  for (size_t i = 0; i < size; ++i)
+                                  {
+                                      const float projected =
+                                          range[i] * std::cos(elevation[i]);
+                                      xyz[i] = {
+                                          projected * std::cos(azimuth[i]),
+                                          projected * std::sin(azimuth[i]),
+                                          range[i] * std::sin(elevation[i])};
+                                  }
+                                  return work;
+                              }));
+}
+
+/**
+ * Measures insertion with eviction, lookup and removal of the LRU cache at
+ * growing sizes. The time per operation should not grow with the size.
+ */
+void benchmarkCache(const Options& options,
+                    std::vector<BenchmarkResult>& results)
+{
+    if (!isEnabled(options, "lruCache"))
+        return;
+
+    for (uint64_t count : {1000, 10000, 100000, 1000000})
+    {
+        // twice as many keys as fit and more insertions than removals, so
+        // the cache runs full and keeps evicting
+        std::vector<uint64_t> keys(count * 4);
+        std::mt19937_64 random(1);
+        std::uniform_int_distribution<uint64_t> keyDistribution(0,
+                                                                count * 2 - 1);
+        for (auto& key : keys)
+        {
+            key = keyDistribution(random);
+        }
+
+        const std::string variant = "items=" + std::to_string(count);
+        std::cerr << "lruCache (" << variant << ")" << std::endl;
+        uint64_t hits = 0;
+        uint64_t evictions = 0;
+        auto result = measure(
+            "", "lruCache", variant, options.iterations,
+            [&]()
+            {
+                SiLRUCache<uint64_t, uint64_t, uint64_t> cache(count);
+                hits = 0;
+                evictions = 0;
+                cache.setEvictionCallback([&evictions](const uint64_t&, auto&)
+                                          { ++evictions; });
+                for (size_t i = 0; i < keys.size(); ++i)
+                {
+                    const uint64_t key = keys[i];
+                    switch (i % 4)
+                    {
+                    case 0:
+                    case 2:
+                        cache.addItem(key, key);
+                        break;
+                    case 3:
+                        cache.removeItem(key);
+                        break;
+                    default:
+                        if (cache.contains(key) && *cache.getItem(key) == key)
+                        {
+                            ++hits;
+                        }
+                        break;
+                    }
+                }
+                return Work{keys.size(), keys.size() * sizeof(uint64_t)};
+            });
+        result.metrics.emplace_back("hits", static_cast<double>(hits));
+        result.metrics.emplace_back("evictions",
+                                    static_cast<double>(evictions));
+        results.push_back(result);
+    }
+}
+
+bool hasField(const std::vector<E57DataInfo>& dataInfo,
+              const std::string& identifier)
+{
+    return std::any_of(dataInfo.begin(), dataInfo.end(),
+                       [&identifier](const auto& info)
+                       { return info.identifier == identifier; });
+}
+
+/**
+ * @return Fields read by the given column layout, empty if the scan does not
+ * support the layout.
+ */
+std::vector<std::string> layoutFields(const std::string& layout,
+                                      const std::vector<E57DataInfo>& dataInfo)
+{
+    std::vector<std::string> fields;
+    if (layout == "all")
+    {
+        for (const auto& info : dataInfo)
+        {
+            fields.push_back(info.identifier);
+        }
+        return fields;
+    }
+
+    if (hasField(dataInfo, "cartesianX"))
+    {
+        fields = {"cartesianX", "cartesianY", "cartesianZ"};
+    }
+    else if (hasField(dataInfo, "sphericalRange"))
+    {
+        fields = {"sphericalRange", "sphericalAzimuth", "sphericalElevation"};
+    }
+    else
+    {
+        return {};
+    }
+
+    if (layout == "coordinates+intensity")
+    {
+        if (!hasField(dataInfo, "intensity"))
+            return {};
+        fields.emplace_back("intensity");
+    }
+    else if (layout == "coordinates+color")
+    {
+        if (!hasField(dataInfo, "colorRed"))
+            return {};
+        fields.insert(fields.end(), {"colorRed", "colorGreen", "colorBlue"});
+    }
+    return fields;
+}
+
+Work readLayout(const E57Reader& reader, const std::string& layout,
+                const Options& options)
+{
+    Work work;
+    for (const auto& data3D : reader.root()->data3D())
+    {
+        if (!data3D->data().contains("points"))
+            continue;
+
+        uint32_t dataId = data3D->data().at("points");
+        auto fields = layoutFields(layout, reader.dataInfo(dataId));
+        if (fields.empty())
+            continue;
+
+        auto dataReader = reader.dataReader(dataId);
+        std::vector<std::vector<float>> buffers(
+            fields.size(), std::vector<float>(options.batchSize));
+        for (size_t i = 0; i < fields.size(); ++i)
+        {
+            dataReader.bindBuffer(fields[i], buffers[i].data(),
+                                  options.batchSize);
+        }
+
+        uint64_t records = 0;
+        uint64_t count;
+        while ((options.maxPoints == 0 || records < options.maxPoints) &&
+               (count = dataReader.read()) > 0)
+        {
+            records += count;
+        }
+
+        work.items += records;
+        work.bytes += records * fields.size() * sizeof(float);
+    }
+    return work;
+}
+
+std::vector<uint32_t> blobIds(const E57Root& root)
+{
+    std::set<uint32_t> result;
+    auto addBlobs = [&result](const E57NodePtr& node)
+    {
+        if (!node)
+            return;
+        for (const auto& [name, blobId] : node->blobs())
+        {
+            result.insert(blobId);
+        }
+    };
+
+    for (const auto& image2D : root.images2D())
+    {
+        addBlobs(image2D->pinholeRepresentation());
+        addBlobs(image2D->sphericalRepresentation());
+        addBlobs(image2D->cylindricalRepresentation());
+    }
+    return {result.begin(), result.end()};
+}
+
+void benchmarkFile(const std::string& file, const Options& options,
+                   std::vector<BenchmarkResult>& results)
+{
+    auto enabled = [&options](const std::string& benchmark)
+    { return isEnabled(options, benchmark); };
+    auto run = [&](const std::string& benchmark, const std::string& variant,
+                   const std::function<Work()>& function)
+    {
+        std::cerr << file << ": " << benchmark << " (" << variant << ")"
+                  << std::endl;
+        try
+        {
+            results.push_back(measure(file, benchmark, variant,
+                                      options.iterations, function));
+        }
+        catch (const std::exception& ex)
+        {
+            std::cerr << "  failed: " << ex.what() << std::endl;
+        }
+    };
+
+    if (enabled("open"))
+    {
+        auto openWith = [&file](const E57ReaderOptions& readerOptions)
+        {
+            E57Reader reader(file, readerOptions);
+            const auto& root = reader.root();
+            return Work{root->data3D().size() + root->images2D().size(), 0};
+        };
+
+        run("open", "eager", [&]() { return openWith({}); });
+        run("open", "lazy", [&]() { return openWith({.lazy = true}); });
+        if (options.index)
+        {
+            // the first open writes the index
+            openWith({.useIndex = true});
+            run("open", "index",
+                [&]() { return openWith({.lazy = true, .useIndex = true}); });
+        }
+    }
+
+    E57Reader reader(file);
+
+    if (enabled("dumpXML"))
+    {
+        for (bool verify : {false, true})
+        {
+            run("dumpXML", verify ? "verify-checksums" : "plain",
+                [&]()
+                {
+                    auto xml = reader.dumpXML(4, verify);
+                    return Work{1, xml.size()};
+                });
+        }
+    }
+
+    if (enabled("blob"))
+    {
+        auto ids = blobIds(*reader.root());
+        run("blob", "blobData",
+            [&]()
+            {
+                Work work;
+                for (uint32_t blobId : ids)
+                {
+                    work.bytes += reader.blobData(blobId).size();
+                    ++work.items;
+                }
+                return work;
+            });
+        run("blob", "stream",
+            [&]()
+            {
+                Work work;
+                for (uint32_t blobId : ids)
+                {
+                    E57BlobStream stream(reader, blobId, options.chunkSize);
+                    for (auto chunk = stream.next(); !chunk.empty();
+                         chunk = stream.next())
+                    {
+                        work.bytes += chunk.size();
+                    }
+                    ++work.items;
+                }
+                return work;
+            });
+    }
+
+    if (enabled("read"))
+    {
+        for (const std::string layout :
+             {"coordinates", "coordinates+intensity", "coordinates+color",
+              "all"})
+        {
+            run("read", layout,
+                [&]() { return readLayout(reader, layout, options); });
+        }
+    }
+
+    if (enabled("createPanorama"))
+    {
+        // the readers of the panorama open the file like the other
+        // benchmarks, from the index only if it is measured
+        Panorama panorama(file, {.lazy = true, .useIndex = options.index});
+        for (const auto& data3D : reader.root()->data3D())
+        {
+            std::string guid = data3D->getString("guid");
+            if (guid.empty())
+                continue;
+            run("createPanorama", data3D->name(),
+                [&]()
+                {
+                    auto image = panorama.createPanorama(guid);
+                    return Work{uint64_t{image.width} * image.height,
+                                image.data.size()};
+                });
+        }
+    }
+
+    if (enabled("getData3D"))
+    {
+        E57Utils utils(reader);
+        for (const auto& data3D : reader.root()->data3D())
+        {
+            run("getData3D", data3D->name(),
+                [&]()
+                {
+                    auto data = utils.getData3D(*data3D);
+                    if (!data)
+                        return Work{};
+                    return Work{data->xyz.size(),
+                                data->xyz.size() * sizeof(data->xyz[0]) +
+                                    data->rgba.size() * sizeof(data->rgba[0]) +
+                                    data->intensity.size() * sizeof(float)};
+                });
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    std::optional<Options> options;
+    try
+    {
+        options = parseArguments(argc, argv);
+    }
+    catch (const std::exception& ex)
+    {
+        std::cerr << ex.what() << std::endl;
+        return 1;
+    }
+
+    if (!options)
+    {
+        printHelp(argv[0]);
+        return 1;
+    }
+
+    std::vector<BenchmarkResult> results;
+    benchmarkKernels(*options, results);
+    benchmarkCache(*options, results);
+    for (const auto& file : options->files)
+    {
+        try
+        {
+            benchmarkFile(file, *options, results);
+        }
+        catch (const std::exception& ex)
+        {
+            std::cerr << "Fatal error: " << ex.what() << std::endl;
+            return 4;
+        }
+    }
+
+    writeJson(std::cout, E57INSPECTOR_VERSION, options->iterations, results);
+    return 0;
+}
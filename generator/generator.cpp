@@ -0,0 +1,561 @@
+#include "generator.h"
+
+#include <E57Format.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include <stb/stb_image_write.h>
+
+namespace
+{
+constexpr double PI = 3.14159265358979323846;
+
+// share of the elevation range covered by the scan, the poles are left out
+constexpr double ELEVATION_COVERAGE = 0.95;
+
+class Random
+{
+public:
+    explicit Random(uint64_t seed) : m_engine(seed) {}
+
+    uint64_t next() { return m_engine(); }
+
+    /**
+     * @return Uniformly distributed value in [0;1) with 53 random bits.
+     */
+    double uniform()
+    {
+        return static_cast<double>(m_engine() >> 11) * 0x1.0p-53;
+    }
+
+    double uniform(double min, double max)
+    {
+        return min + (max - min) * uniform();
+    }
+
+private:
+    std::mt19937_64 m_engine;
+};
+
+/**
+ * Derives an independent seed per stream (splitmix64), so every scan and
+ * image is reproducible on its own.
+ */
+uint64_t streamSeed(uint64_t seed, uint64_t stream)
+{
+    uint64_t z = seed + 0x9E3779B97F4A7C15ull * (stream + 1);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+std::string makeGuid(Random& random)
+{
+    uint64_t a = random.next();
+    uint64_t b = random.next();
+    char guid[40];
+    std::snprintf(guid, sizeof(guid), "{%08X-%04X-%04X-%04X-%012llX}",
+                  static_cast<uint32_t>(a >> 32),
+                  static_cast<uint32_t>((a >> 16) & 0xFFFF),
+                  static_cast<uint32_t>(a & 0xFFFF),
+                  static_cast<uint32_t>(b >> 48),
+                  static_cast<unsigned long long>(b & 0xFFFFFFFFFFFFull));
+    return guid;
+}
+
+void setFloat(e57::StructureNode& node, const std::string& name, double value)
+{
+    node.set(name, e57::FloatNode(node.destImageFile(), value));
+}
+
+void setInteger(e57::StructureNode& node, const std::string& name,
+                int64_t value)
+{
+    node.set(name, e57::IntegerNode(node.destImageFile(), value));
+}
+
+void setString(e57::StructureNode& node, const std::string& name,
+               const std::string& value)
+{
+    node.set(name, e57::StringNode(node.destImageFile(), value));
+}
+
+void setPose(e57::StructureNode& node, const std::array<double, 3>& position,
+             double yaw)
+{
+    e57::ImageFile imf = node.destImageFile();
+    e57::StructureNode pose(imf);
+    node.set("pose", pose);
+
+    e57::StructureNode rotation(imf);
+    pose.set("rotation", rotation);
+    setFloat(rotation, "w", std::cos(yaw / 2.0));
+    setFloat(rotation, "x", 0.0);
+    setFloat(rotation, "y", 0.0);
+    setFloat(rotation, "z", std::sin(yaw / 2.0));
+
+    e57::StructureNode translation(imf);
+    pose.set("translation", translation);
+    setFloat(translation, "x", position[0]);
+    setFloat(translation, "y", position[1]);
+    setFloat(translation, "z", position[2]);
+}
+
+/**
+ * Room around the scanner, an axis aligned box given by its half extents.
+ */
+struct Room
+{
+    std::array<double, 3> halfExtent;
+
+    [[nodiscard]] double maxRange() const
+    {
+        return std::sqrt(halfExtent[0] * halfExtent[0] +
+                         halfExtent[1] * halfExtent[1] +
+                         halfExtent[2] * halfExtent[2]);
+    }
+};
+
+Room makeRoom(uint32_t scanIndex)
+{
+    return {{6.0 + 2.0 * (scanIndex % 4), 4.0 + (scanIndex % 3), 1.5}};
+}
+
+struct Grid
+{
+    uint64_t rows;
+    uint64_t columns;
+};
+
+Grid makeGrid(uint64_t points)
+{
+    // twice as many columns as rows, as azimuth spans twice the elevation
+    auto columns = static_cast<uint64_t>(
+        std::ceil(std::sqrt(2.0 * static_cast<double>(points))));
+    columns = std::max<uint64_t>(columns, 1);
+    uint64_t rows = std::max<uint64_t>((points + columns - 1) / columns, 1);
+    return {rows, columns};
+}
+
+struct PointBuffers
+{
+    std::vector<float> coordinate0;
+    std::vector<float> coordinate1;
+    std::vector<float> coordinate2;
+    std::vector<int8_t> invalidState;
+    std::vector<int32_t> rowIndex;
+    std::vector<int32_t> columnIndex;
+    std::vector<float> intensity;
+    std::vector<uint8_t> colorRed;
+    std::vector<uint8_t> colorGreen;
+    std::vector<uint8_t> colorBlue;
+};
+
+void writeScan(const GeneratorOptions& options, e57::ImageFile& imf,
+               e57::VectorNode& data3D, uint32_t scanIndex,
+               const std::string& guid)
+{
+    const bool cartesian =
+        options.coordinates == GeneratorOptions::Coordinates::CARTESIAN;
+    const Room room = makeRoom(scanIndex);
+    const Grid grid = makeGrid(options.points);
+    const double maxRange = room.maxRange() + 0.01;
+
+    e57::StructureNode scan(imf);
+    data3D.append(scan);
+
+    char name[32];
+    std::snprintf(name, sizeof(name), "Scan %03u", scanIndex);
+    setString(scan, "guid", guid);
+    setString(scan, "name", name);
+    setString(scan, "description", "Synthetic scan");
+    setPose(scan, {20.0 * scanIndex, 0.0, 0.0}, 0.0);
+
+    if (cartesian)
+    {
+        e57::StructureNode bounds(imf);
+        scan.set("cartesianBounds", bounds);
+        setFloat(bounds, "xMinimum", -room.halfExtent[0]);
+        setFloat(bounds, "xMaximum", room.halfExtent[0]);
+        setFloat(bounds, "yMinimum", -room.halfExtent[1]);
+        setFloat(bounds, "yMaximum", room.halfExtent[1]);
+        setFloat(bounds, "zMinimum", -room.halfExtent[2]);
+        setFloat(bounds, "zMaximum", room.halfExtent[2]);
+    }
+    else
+    {
+        e57::StructureNode bounds(imf);
+        scan.set("sphericalBounds", bounds);
+        setFloat(bounds, "rangeMinimum", 0.0);
+        setFloat(bounds, "rangeMaximum", maxRange);
+        setFloat(bounds, "elevationMinimum", -PI / 2.0 * ELEVATION_COVERAGE);
+        setFloat(bounds, "elevationMaximum", PI / 2.0 * ELEVATION_COVERAGE);
+        setFloat(bounds, "azimuthStart", -PI);
+        setFloat(bounds, "azimuthEnd", PI);
+    }
+
+    if (options.rowColumnIndex)
+    {
+        e57::StructureNode bounds(imf);
+        scan.set("indexBounds", bounds);
+        setInteger(bounds, "rowMinimum", 0);
+        setInteger(bounds, "rowMaximum", static_cast<int64_t>(grid.rows) - 1);
+        setInteger(bounds, "columnMinimum", 0);
+        setInteger(bounds, "columnMaximum",
+                   static_cast<int64_t>(grid.columns) - 1);
+        setInteger(bounds, "returnMinimum", 0);
+        setInteger(bounds, "returnMaximum", 0);
+    }
+
+    if (options.intensity)
+    {
+        e57::StructureNode limits(imf);
+        scan.set("intensityLimits", limits);
+        setFloat(limits, "intensityMinimum", 0.0);
+        setFloat(limits, "intensityMaximum", 1.0);
+    }
+
+    if (options.color)
+    {
+        e57::StructureNode limits(imf);
+        scan.set("colorLimits", limits);
+        for (const char* channel : {"Red", "Green", "Blue"})
+        {
+            setInteger(limits, std::string("color") + channel + "Minimum", 0);
+            setInteger(limits, std::string("color") + channel + "Maximum",
+                       255);
+        }
+    }
+
+    // prototype and buffers
+    const size_t batchSize = options.batchSize;
+    PointBuffers buffers;
+    std::vector<e57::SourceDestBuffer> sourceBuffers;
+    e57::StructureNode prototype(imf);
+
+    auto addFloat = [&](const std::string& field, std::vector<float>& buffer,
+                        double min, double max)
+    {
+        prototype.set(field,
+                      e57::FloatNode(imf, 0.0, e57::PrecisionSingle, min, max));
+        buffer.resize(batchSize);
+        sourceBuffers.emplace_back(imf, field, buffer.data(), batchSize);
+    };
+    auto addInteger = [&](const std::string& field, auto& buffer, int64_t min,
+                          int64_t max)
+    {
+        prototype.set(field, e57::IntegerNode(imf, min, min, max));
+        buffer.resize(batchSize);
+        sourceBuffers.emplace_back(imf, field, buffer.data(), batchSize);
+    };
+
+    if (cartesian)
+    {
+        addFloat("cartesianX", buffers.coordinate0, -maxRange, maxRange);
+        addFloat("cartesianY", buffers.coordinate1, -maxRange, maxRange);
+        addFloat("cartesianZ", buffers.coordinate2, -maxRange, maxRange);
+    }
+    else
+    {
+        addFloat("sphericalRange", buffers.coordinate0, 0.0, maxRange);
+        addFloat("sphericalAzimuth", buffers.coordinate1, -PI, PI);
+        addFloat("sphericalElevation", buffers.coordinate2, -PI / 2.0,
+                 PI / 2.0);
+    }
+    if (options.invalidState)
+    {
+        addInteger(cartesian ? "cartesianInvalidState"
+                             : "sphericalInvalidState",
+                   buffers.invalidState, 0, 2);
+    }
+    if (options.rowColumnIndex)
+    {
+        addInteger("rowIndex", buffers.rowIndex, 0,
+                   static_cast<int64_t>(grid.rows) - 1);
+        addInteger("columnIndex", buffers.columnIndex, 0,
+                   static_cast<int64_t>(grid.columns) - 1);
+    }
+    if (options.intensity)
+    {
+        addFloat("intensity", buffers.intensity, 0.0, 1.0);
+    }
+    if (options.color)
+    {
+        addInteger("colorRed", buffers.colorRed, 0, 255);
+        addInteger("colorGreen", buffers.colorGreen, 0, 255);
+        addInteger("colorBlue", buffers.colorBlue, 0, 255);
+    }
+
+    e57::VectorNode codecs(imf, true);
+    e57::CompressedVectorNode points(imf, prototype, codecs);
+    scan.set("points", points);
+
+    // the color of each of the six walls, indexed by axis and direction
+    static const std::array<std::array<double, 3>, 6> WALL_COLORS = {{
+        {0.9, 0.4, 0.3},
+        {0.3, 0.8, 0.4},
+        {0.3, 0.5, 0.9},
+        {0.9, 0.8, 0.3},
+        {0.6, 0.6, 0.6},
+        {0.8, 0.4, 0.8},
+    }};
+
+    Random random(streamSeed(options.seed, 2 * scanIndex));
+    e57::CompressedVectorWriter writer = points.writer(sourceBuffers);
+    for (uint64_t first = 0; first < options.points; first += batchSize)
+    {
+        const size_t count = static_cast<size_t>(
+            std::min<uint64_t>(batchSize, options.points - first));
+        for (size_t i = 0; i < count; ++i)
+        {
+            // points are ordered column by column, like a rotating scanner
+            const uint64_t index = first + i;
+            const uint64_t column = index / grid.rows;
+            const uint64_t row = index % grid.rows;
+
+            const double azimuth =
+                -PI + (column + 0.5) * 2.0 * PI / grid.columns;
+            const double elevation =
+                (-0.5 + (row + 0.5) / grid.rows) * PI * ELEVATION_COVERAGE;
+            const std::array<double, 3> direction = {
+                std::cos(elevation) * std::cos(azimuth),
+                std::cos(elevation) * std::sin(azimuth), std::sin(elevation)};
+
+            // all values are drawn for every point, so the geometry does not
+            // depend on the selected fields
+            const double rangeNoise = random.uniform(-0.005, 0.005);
+            const double intensityNoise = random.uniform(-0.05, 0.05);
+            const bool invalid = random.uniform() < options.invalidRatio;
+
+            size_t wall = 0;
+            double range = std::numeric_limits<double>::max();
+            for (size_t axis = 0; axis < 3; ++axis)
+            {
+                if (direction[axis] == 0.0)
+                    continue;
+                double distance =
+                    room.halfExtent[axis] / std::abs(direction[axis]);
+                if (distance < range)
+                {
+                    range = distance;
+                    wall = 2 * axis + (direction[axis] < 0.0 ? 1 : 0);
+                }
+            }
+            range += rangeNoise;
+
+            // checkerboard of one meter tiles on the walls
+            const std::array<double, 3> hit = {range * direction[0],
+                                               range * direction[1],
+                                               range * direction[2]};
+            const auto tile = static_cast<int64_t>(std::floor(hit[0])) +
+                              static_cast<int64_t>(std::floor(hit[1])) +
+                              static_cast<int64_t>(std::floor(hit[2]));
+            const double intensity = std::clamp(
+                0.3 + 0.3 * (tile & 1) + 0.3 * std::abs(direction[wall / 2]) +
+                    intensityNoise,
+                0.0, 1.0);
+
+            const bool isInvalid = options.invalidState && invalid;
+            if (cartesian)
+            {
+                buffers.coordinate0[i] =
+                    isInvalid ? 0.0f : static_cast<float>(hit[0]);
+                buffers.coordinate1[i] =
+                    isInvalid ? 0.0f : static_cast<float>(hit[1]);
+                buffers.coordinate2[i] =
+                    isInvalid ? 0.0f : static_cast<float>(hit[2]);
+            }
+            else
+            {
+                buffers.coordinate0[i] =
+                    isInvalid ? 0.0f : static_cast<float>(range);
+                buffers.coordinate1[i] = static_cast<float>(azimuth);
+                buffers.coordinate2[i] = static_cast<float>(elevation);
+            }
+            if (options.invalidState)
+            {
+                buffers.invalidState[i] = isInvalid ? 2 : 0;
+            }
+            if (options.rowColumnIndex)
+            {
+                buffers.rowIndex[i] = static_cast<int32_t>(row);
+                buffers.columnIndex[i] = static_cast<int32_t>(column);
+            }
+            if (options.intensity)
+            {
+                buffers.intensity[i] = static_cast<float>(intensity);
+            }
+            if (options.color)
+            {
+                const auto& color = WALL_COLORS[wall];
+                buffers.colorRed[i] =
+                    static_cast<uint8_t>(255.0 * color[0] * intensity);
+                buffers.colorGreen[i] =
+                    static_cast<uint8_t>(255.0 * color[1] * intensity);
+                buffers.colorBlue[i] =
+                    static_cast<uint8_t>(255.0 * color[2] * intensity);
+            }
+        }
+        writer.write(count);
+    }
+    writer.close();
+}
+
+std::vector<uint8_t> encodeJpeg(uint32_t width, uint32_t height,
+                                Random& random)
+{
+    // smooth gradients with a little noise, so the JPEG size is realistic
+    std::vector<uint8_t> pixels(static_cast<size_t>(width) * height * 3);
+    for (uint32_t y = 0; y < height; ++y)
+    {
+        for (uint32_t x = 0; x < width; ++x)
+        {
+            const size_t offset = (static_cast<size_t>(y) * width + x) * 3;
+            const double noise = random.uniform(-8.0, 8.0);
+            const double u = static_cast<double>(x) / width;
+            const double v = static_cast<double>(y) / height;
+            pixels[offset + 0] =
+                static_cast<uint8_t>(std::clamp(255.0 * u + noise, 0.0, 255.0));
+            pixels[offset + 1] =
+                static_cast<uint8_t>(std::clamp(255.0 * v + noise, 0.0, 255.0));
+            pixels[offset + 2] = static_cast<uint8_t>(
+                std::clamp(128.0 + 96.0 * std::sin(8.0 * PI * u) + noise, 0.0,
+                           255.0));
+        }
+    }
+
+    std::vector<uint8_t> jpeg;
+    auto append = [](void* context, void* data, int size)
+    {
+        auto* bytes = static_cast<std::vector<uint8_t>*>(context);
+        auto* first = static_cast<uint8_t*>(data);
+        bytes->insert(bytes->end(), first, first + size);
+    };
+    if (!stbi_write_jpg_to_func(append, &jpeg, static_cast<int>(width),
+                                static_cast<int>(height), 3, pixels.data(),
+                                90))
+    {
+        throw std::runtime_error("Cannot encode image.");
+    }
+    return jpeg;
+}
+
+void writeImage(const GeneratorOptions& options, e57::ImageFile& imf,
+                e57::VectorNode& images2D, uint32_t scanIndex,
+                uint32_t imageIndex, const std::string& scanGuid)
+{
+    Random random(streamSeed(options.seed, 2 * scanIndex + 1) + imageIndex);
+
+    e57::StructureNode image(imf);
+    images2D.append(image);
+
+    char name[32];
+    std::snprintf(name, sizeof(name), "Image %03u-%02u", scanIndex,
+                  imageIndex);
+    setString(image, "guid", makeGuid(random));
+    setString(image, "name", name);
+    setString(image, "associatedData3DGuid", scanGuid);
+
+    const bool pinhole =
+        options.imageType == GeneratorOptions::ImageType::PINHOLE;
+    const double yaw =
+        pinhole ? 2.0 * PI * imageIndex / options.imagesPerScan : 0.0;
+    setPose(image, {20.0 * scanIndex, 0.0, 0.0}, yaw);
+
+    e57::StructureNode representation(imf);
+    image.set(pinhole ? "pinholeRepresentation" : "sphericalRepresentation",
+              representation);
+    setInteger(representation, "imageWidth", options.imageWidth);
+    setInteger(representation, "imageHeight", options.imageHeight);
+    if (pinhole)
+    {
+        // 90 degrees horizontal field of view
+        const double pixelSize = 5e-6;
+        setFloat(representation, "pixelWidth", pixelSize);
+        setFloat(representation, "pixelHeight", pixelSize);
+        setFloat(representation, "focalLength",
+                 pixelSize * options.imageWidth / 2.0);
+        setFloat(representation, "principalPointX",
+                 options.imageWidth / 2.0);
+        setFloat(representation, "principalPointY",
+                 options.imageHeight / 2.0);
+    }
+    else
+    {
+        setFloat(representation, "pixelWidth", 2.0 * PI / options.imageWidth);
+        setFloat(representation, "pixelHeight", PI / options.imageHeight);
+    }
+
+    auto jpeg = encodeJpeg(options.imageWidth, options.imageHeight, random);
+    e57::BlobNode blob(imf, static_cast<int64_t>(jpeg.size()));
+    representation.set("jpegImage", blob);
+    blob.write(jpeg.data(), 0, jpeg.size());
+}
+} // namespace
+
+Generator::Generator(GeneratorOptions options) : m_options(std::move(options))
+{
+    if (m_options.batchSize == 0)
+    {
+        throw std::runtime_error("Invalid batch size.");
+    }
+    if (m_options.imagesPerScan > 0 &&
+        (m_options.imageWidth == 0 || m_options.imageHeight == 0))
+    {
+        throw std::runtime_error("Invalid image size.");
+    }
+}
+
+void Generator::generate(const std::string& filename) const
+{
+    e57::ImageFile imf(filename, "w");
+    try
+    {
+        Random random(m_options.seed);
+        e57::StructureNode root = imf.root();
+        setString(root, "formatName", "ASTM E57 3D Imaging Data File");
+        setString(root, "guid", makeGuid(random));
+        root.set("versionMajor", e57::IntegerNode(imf, 1));
+        root.set("versionMinor", e57::IntegerNode(imf, 0));
+        setString(root, "coordinateMetadata", "");
+
+        // fixed, so the output does not depend on the time of generation
+        e57::StructureNode creationDateTime(imf);
+        root.set("creationDateTime", creationDateTime);
+        setFloat(creationDateTime, "dateTimeValue", 1.0e9);
+        creationDateTime.set("isAtomicClockReferenced",
+                             e57::IntegerNode(imf, 0, 0, 1));
+
+        e57::VectorNode data3D(imf, true);
+        root.set("data3D", data3D);
+        e57::VectorNode images2D(imf, true);
+        root.set("images2D", images2D);
+
+        for (uint32_t scanIndex = 0; scanIndex < m_options.scans; ++scanIndex)
+        {
+            const std::string guid = makeGuid(random);
+            writeScan(m_options, imf, data3D, scanIndex, guid);
+            for (uint32_t imageIndex = 0; imageIndex < m_options.imagesPerScan;
+                 ++imageIndex)
+            {
+                writeImage(m_options, imf, images2D, scanIndex, imageIndex,
+                           guid);
+            }
+        }
+    }
+    catch (...)
+    {
+        imf.close();
+        throw;
+    }
+    imf.close();
+}
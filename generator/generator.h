@@ -0,0 +1,63 @@
+#ifndef E57INSPECTOR_GENERATOR_H
+#define E57INSPECTOR_GENERATOR_H
+
+#include <cstdint>
+#include <string>
+
+struct GeneratorOptions
+{
+    enum class Coordinates
+    {
+        CARTESIAN,
+        SPHERICAL
+    };
+
+    enum class ImageType
+    {
+        PINHOLE,
+        SPHERICAL
+    };
+
+    uint64_t seed{1};
+    uint32_t scans{1};
+    uint64_t points{1000000};
+    Coordinates coordinates{Coordinates::CARTESIAN};
+    bool rowColumnIndex{false};
+    bool intensity{false};
+    bool color{false};
+    bool invalidState{false};
+    // share of invalid points if invalidState is set
+    double invalidRatio{0.01};
+
+    uint32_t imagesPerScan{0};
+    uint32_t imageWidth{1024};
+    uint32_t imageHeight{768};
+    ImageType imageType{ImageType::PINHOLE};
+
+    uint32_t batchSize{1 << 20};
+};
+
+/**
+ * Writes synthetic E57 files. Every scan samples a box shaped room around
+ * the scanner on a regular azimuth/elevation grid. The output only depends
+ * on the options, the same seed always yields the same file. Random values
+ * are derived from the raw std::mt19937_64 output, as the standard
+ * distributions differ between standard libraries. Points are written in
+ * batches, so the point count is not limited by memory.
+ */
+class Generator
+{
+public:
+    explicit Generator(GeneratorOptions options);
+
+    /**
+     * Writes the E57 file. A runtime exception is thrown on failure.
+     * @param filename Path of the E57 file to write.
+     */
+    void generate(const std::string& filename) const;
+
+private:
+    GeneratorOptions m_options;
+};
+
+#endif // E57INSPECTOR_GENERATOR_H
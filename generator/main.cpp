@@ -0,0 +1,150 @@
+#include "generator.h"
+
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+
+void printHelp(const std::string& exePath)
+{
+    std::cout
+        << "Usage: " << exePath << " [OPTIONS] OUTPUT.e57\n\n"
+        << "Writes a synthetic E57 file. The same options always produce the\n"
+        << "same file.\n\n"
+        << "Options:\n"
+        << "  --seed N               Random seed (default 1)\n"
+        << "  --scans N              Number of scans (default 1)\n"
+        << "  --points N             Points per scan (default 1000000)\n"
+        << "  --coordinates TYPE     cartesian or spherical\n"
+        << "                         (default cartesian)\n"
+        << "  --row-column           Write rowIndex and columnIndex\n"
+        << "  --intensity            Write intensity\n"
+        << "  --color                Write colorRed, colorGreen and colorBlue\n"
+        << "  --invalid-state        Write the invalid state field\n"
+        << "  --invalid-ratio R      Share of invalid points (default 0.01)\n"
+        << "  --images N             Images2D per scan (default 0)\n"
+        << "  --image-size WxH       Image size in pixels (default 1024x768)\n"
+        << "  --image-type TYPE      pinhole or spherical (default pinhole)\n"
+        << "  --batch-size N         Points per write call (default 1048576)"
+        << std::endl;
+}
+
+struct Arguments
+{
+    GeneratorOptions options;
+    std::string output;
+};
+
+std::optional<Arguments> parseArguments(int argc, char* argv[])
+{
+    Arguments arguments;
+    auto& options = arguments.options;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg(argv[i]);
+        auto value = [&]() -> std::string
+        {
+            if (i + 1 >= argc)
+            {
+                throw std::runtime_error("Missing value for " + arg + ".");
+            }
+            return argv[++i];
+        };
+
+        if (arg == "--seed")
+            options.seed = std::stoull(value());
+        else if (arg == "--scans")
+            options.scans = std::stoul(value());
+        else if (arg == "--points")
+            options.points = std::stoull(value());
+        else if (arg == "--coordinates")
+        {
+            auto type = value();
+            if (type == "cartesian")
+                options.coordinates = GeneratorOptions::Coordinates::CARTESIAN;
+            else if (type == "spherical")
+                options.coordinates = GeneratorOptions::Coordinates::SPHERICAL;
+            else
+                throw std::runtime_error("Unknown coordinates " + type + ".");
+        }
+        else if (arg == "--row-column")
+            options.rowColumnIndex = true;
+        else if (arg == "--intensity")
+            options.intensity = true;
+        else if (arg == "--color")
+            options.color = true;
+        else if (arg == "--invalid-state")
+            options.invalidState = true;
+        else if (arg == "--invalid-ratio")
+            options.invalidRatio = std::stod(value());
+        else if (arg == "--images")
+            options.imagesPerScan = std::stoul(value());
+        else if (arg == "--image-size")
+        {
+            auto size = value();
+            auto separator = size.find('x');
+            if (separator == std::string::npos)
+                throw std::runtime_error("Invalid image size " + size + ".");
+            options.imageWidth = std::stoul(size.substr(0, separator));
+            options.imageHeight = std::stoul(size.substr(separator + 1));
+        }
+        else if (arg == "--image-type")
+        {
+            auto type = value();
+            if (type == "pinhole")
+                options.imageType = GeneratorOptions::ImageType::PINHOLE;
+            else if (type == "spherical")
+                options.imageType = GeneratorOptions::ImageType::SPHERICAL;
+            else
+                throw std::runtime_error("Unknown image type " + type + ".");
+        }
+        else if (arg == "--batch-size")
+            options.batchSize = std::stoul(value());
+        else if (arg == "--help" || arg == "-h")
+            return std::nullopt;
+        else if (arg.starts_with("--"))
+            throw std::runtime_error("Unknown option " + arg + ".");
+        else if (arguments.output.empty())
+            arguments.output = arg;
+        else
+            throw std::runtime_error("Unexpected argument " + arg + ".");
+    }
+
+    if (arguments.output.empty())
+    {
+        return std::nullopt;
+    }
+    return arguments;
+}
+
+int main(int argc, char* argv[])
+{
+    std::optional<Arguments> arguments;
+    try
+    {
+        arguments = parseArguments(argc, argv);
+    }
+    catch (const std::exception& ex)
+    {
+        std::cerr << ex.what() << std::endl;
+        return 1;
+    }
+
+    if (!arguments)
+    {
+        printHelp(argv[0]);
+        return 1;
+    }
+
+    try
+    {
+        Generator generator(arguments->options);
+        generator.generate(arguments->output);
+    }
+    catch (const std::exception& ex)
+    {
+        std::cerr << "Fatal error: " << ex.what() << std::endl;
+        return 4;
+    }
+
+    return 0;
+}
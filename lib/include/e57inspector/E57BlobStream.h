@@ -0,0 +1,83 @@
+#ifndef E57INSPECTOR_E57BLOBSTREAM_H
+#define E57INSPECTOR_E57BLOBSTREAM_H
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <span>
+
+#include "E57Reader.h"
+
+/**
+ * Reads a blob sequentially in chunks, so large images can be consumed
+ * without holding the whole blob in memory. Either pulls chunks into an
+ * internal buffer with next(), or reads into caller-owned buffers with
+ * read().
+ *
+ * Example:
+ *     E57BlobStream stream(e57Reader, blobId);
+ *     for (auto chunk = stream.next(); !chunk.empty(); chunk = stream.next())
+ *     {
+ *         ...
+ *     }
+ */
+class E57BlobStream
+{
+public:
+    static constexpr size_t DEFAULT_CHUNK_SIZE = 1 << 20;
+
+    /**
+     * @param reader Reader the blob belongs to. Must outlive the stream.
+     * @param blobId Id of the blob.
+     * @param chunkSize Size of the chunks returned by next().
+     */
+    E57BlobStream(const E57Reader& reader, uint32_t blobId,
+                  size_t chunkSize = DEFAULT_CHUNK_SIZE)
+        : m_reader(reader), m_blobId(blobId), m_size(reader.blobSize(blobId)),
+          m_chunkSize(chunkSize)
+    {
+    }
+
+    /**
+     * Reads the next chunk into the internal buffer.
+     * @return View of the chunk, empty at the end of the blob. Valid until
+     * the next call to next().
+     */
+    std::span<const uint8_t> next()
+    {
+        if (!m_chunk)
+        {
+            m_chunk = std::make_unique_for_overwrite<uint8_t[]>(m_chunkSize);
+        }
+        std::span<uint8_t> chunk(m_chunk.get(), m_chunkSize);
+        return chunk.first(read(chunk));
+    }
+
+    /**
+     * Reads the next bytes into the given buffer.
+     * @return Number of bytes read, 0 at the end of the blob.
+     */
+    size_t read(std::span<uint8_t> buffer)
+    {
+        auto count = static_cast<size_t>(
+            m_reader.readBlob(m_blobId, m_position, buffer));
+        m_position += count;
+        return count;
+    }
+
+    void seek(uint64_t position) { m_position = std::min(position, m_size); }
+
+    [[nodiscard]] uint64_t position() const { return m_position; }
+    [[nodiscard]] uint64_t size() const { return m_size; }
+    [[nodiscard]] bool atEnd() const { return m_position >= m_size; }
+
+private:
+    const E57Reader& m_reader;
+    uint32_t m_blobId;
+    uint64_t m_size;
+    uint64_t m_position{0};
+    size_t m_chunkSize;
+    std::unique_ptr<uint8_t[]> m_chunk;
+};
+
+#endif // E57INSPECTOR_E57BLOBSTREAM_H
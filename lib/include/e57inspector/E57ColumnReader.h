@@ -0,0 +1,128 @@
+#ifndef E57INSPECTOR_E57COLUMNREADER_H
+#define E57INSPECTOR_E57COLUMNREADER_H
+
+#include <array>
+#include <memory>
+#include <new>
+#include <span>
+#include <string>
+#include <tuple>
+#include <utility>
+
+#include "E57Reader.h"
+
+/**
+ * Reads a compressed vector column by column (structure of arrays). Every
+ * column owns a cache-line aligned buffer of batchSize elements which is
+ * allocated once and reused for every batch. The element type of each column
+ * is chosen at compile time, the values are converted by libE57Format.
+ *
+ * Example:
+ *     E57ColumnReader<float, float, float> reader(
+ *         e57Reader.dataReader(id),
+ *         {"cartesianX", "cartesianY", "cartesianZ"});
+ *     while (reader.read() > 0)
+ *     {
+ *         auto x = reader.column<0>();
+ *         ...
+ *     }
+ */
+template <typename... Ts> class E57ColumnReader
+{
+public:
+    static constexpr size_t COLUMN_COUNT = sizeof...(Ts);
+    static constexpr uint32_t DEFAULT_BATCH_SIZE = 10000;
+
+    template <size_t I>
+    using column_type = std::tuple_element_t<I, std::tuple<Ts...>>;
+
+    /**
+     * @param dataReader Data reader of the compressed vector.
+     * @param identifiers Field name per column. Columns with an empty name or
+     * a name which is not defined by the prototype are skipped and stay
+     * empty.
+     * @param batchSize Number of records decoded per batch.
+     */
+    E57ColumnReader(E57DataReader dataReader,
+                    const std::array<std::string, COLUMN_COUNT>& identifiers,
+                    uint32_t batchSize = DEFAULT_BATCH_SIZE)
+        : m_dataReader(std::move(dataReader)), m_batchSize(batchSize)
+    {
+        bindColumns(identifiers, std::index_sequence_for<Ts...>{});
+    }
+
+    /**
+     * Decodes the next batch into the column buffers.
+     * @return Number of records in the batch, 0 at the end.
+     */
+    uint64_t read()
+    {
+        m_count = m_dataReader.read();
+        return m_count;
+    }
+
+    /**
+     * @return View of column I for the current batch. Empty if the column is
+     * not present. Valid until the next call to read().
+     */
+    template <size_t I>
+    [[nodiscard]] std::span<const column_type<I>> column() const
+    {
+        const auto& buffer = std::get<I>(m_columns);
+        if (!buffer)
+            return {};
+        return {buffer.get(), static_cast<size_t>(m_count)};
+    }
+
+    template <size_t I> [[nodiscard]] bool hasColumn() const
+    {
+        return static_cast<bool>(std::get<I>(m_columns));
+    }
+
+    [[nodiscard]] uint64_t size() const { return m_count; }
+    [[nodiscard]] uint32_t batchSize() const { return m_batchSize; }
+    [[nodiscard]] uint64_t recordCount() const
+    {
+        return m_dataReader.recordCount();
+    }
+
+private:
+    static constexpr std::align_val_t ALIGNMENT{64};
+
+    struct AlignedDelete
+    {
+        void operator()(void* ptr) const
+        {
+            ::operator delete[](ptr, ALIGNMENT);
+        }
+    };
+
+    template <typename T>
+    using AlignedBuffer = std::unique_ptr<T[], AlignedDelete>;
+
+    E57DataReader m_dataReader;
+    uint32_t m_batchSize;
+    uint64_t m_count{0};
+    std::tuple<AlignedBuffer<Ts>...> m_columns;
+
+    template <size_t... Is>
+    void bindColumns(const std::array<std::string, COLUMN_COUNT>& identifiers,
+                     std::index_sequence<Is...>)
+    {
+        (bindColumn<Is>(identifiers[Is]), ...);
+    }
+
+    template <size_t I> void bindColumn(const std::string& identifier)
+    {
+        using T = column_type<I>;
+        if (identifier.empty() || !m_dataReader.hasField(identifier))
+            return;
+
+        auto& buffer = std::get<I>(m_columns);
+        buffer.reset(static_cast<T*>(
+            ::operator new[](sizeof(T) * m_batchSize, ALIGNMENT)));
+        m_dataReader.bindBuffer(identifier, buffer.get(), m_batchSize);
+    }
+};
+
+#endif // E57INSPECTOR_E57COLUMNREADER_H
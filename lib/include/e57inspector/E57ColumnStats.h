@@ -0,0 +1,79 @@
+#ifndef E57INSPECTOR_E57COLUMNSTATS_H
+#define E57INSPECTOR_E57COLUMNSTATS_H
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+/**
+ * Statistics of one column of a compressed vector.
+ */
+struct E57ColumnStats
+{
+    static constexpr size_t HISTOGRAM_BINS = 256;
+
+    std::string identifier;
+    uint64_t count{0};
+    double minValue{0.0};
+    double maxValue{0.0};
+    double mean{0.0};
+
+    // equally wide bins covering [histogramMin, histogramMax), which
+    // contains [minValue, maxValue]
+    double histogramMin{0.0};
+    double histogramMax{0.0};
+    std::vector<uint64_t> histogram;
+
+    /**
+     * Estimates a percentile from the histogram, interpolating linearly
+     * within the bin it falls into.
+     * @param p Percentile in [0;100].
+     */
+    [[nodiscard]] double percentile(double p) const;
+
+    /**
+     * Maps a value linearly from [minValue, maxValue] to [0;1].
+     */
+    [[nodiscard]] float normalize(float value) const
+    {
+        if (maxValue <= minValue)
+            return 0.0f;
+        return static_cast<float>((value - minValue) / (maxValue - minValue));
+    }
+};
+
+/**
+ * Accumulates column statistics batch by batch while a column is decoded.
+ * Minimum, maximum and sum are computed with SIMD reductions. The histogram
+ * adapts its range to the values seen so far by doubling its bin width, so
+ * no second pass over the data is needed. A runtime exception is thrown for
+ * non-finite values, infinity and NaN, and the batch is not added then.
+ */
+class E57ColumnStatsAccumulator
+{
+public:
+    E57ColumnStatsAccumulator();
+
+    void add(std::span<const float> values);
+    void add(std::span<const double> values);
+
+    [[nodiscard]] uint64_t count() const { return m_count; }
+    [[nodiscard]] E57ColumnStats result(const std::string& identifier) const;
+
+private:
+    uint64_t m_count{0};
+    double m_min;
+    double m_max;
+    double m_sum{0.0};
+
+    double m_histogramMin{0.0};
+    double m_binWidth{0.0};
+    std::vector<uint64_t> m_histogram;
+
+    template <typename T>
+    void add(std::span<const T> values, double min, double max, double sum);
+    void extendHistogram(double min, double max);
+};
+
+#endif // E57INSPECTOR_E57COLUMNSTATS_H
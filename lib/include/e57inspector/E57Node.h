@@ -1,12 +1,14 @@
 #ifndef E57INSPECTOR_E57NODE_H
 #define E57INSPECTOR_E57NODE_H
 
+#include <functional>
 #include <memory>
 #include <string>
-#include <unordered_map>
 #include <vector>
 #include <array>
 
+#include "E57PropertyMap.h"
+
 struct E57Quaternion
 {
     double x;
@@ -24,11 +26,12 @@ struct E57Pose
 class E57Node
 {
 public:
-    using strings_t = std::unordered_map<std::string, std::string>;
-    using integers_t = std::unordered_map<std::string, int64_t>;
-    using floats_t = std::unordered_map<std::string, double>;
-    using blobs_t = std::unordered_map<std::string, uint32_t>;
-    using data_t = std::unordered_map<std::string, uint32_t>;
+    using strings_t = E57PropertyMap<std::string>;
+    using integers_t = E57PropertyMap<int64_t>;
+    using floats_t = E57PropertyMap<double>;
+    using blobs_t = E57PropertyMap<uint32_t>;
+    using data_t = E57PropertyMap<uint32_t>;
+    using loader_t = std::function<void(E57Node& node)>;
 
     E57Node() = default;
     virtual ~E57Node() = default;
@@ -36,48 +39,93 @@ public:
     [[nodiscard]] std::string name() const { return m_name; }
     void setName(const std::string& name) { m_name = name; }
 
-    [[nodiscard]] const strings_t& strings() const { return m_strings; }
-    [[nodiscard]] const integers_t& integers() const { return m_integers; }
-    [[nodiscard]] const floats_t& floats() const { return m_floats; }
-    [[nodiscard]] const blobs_t& blobs() const { return m_blobs; }
+    [[nodiscard]] const strings_t& strings() const { return load().m_strings; }
+    [[nodiscard]] const integers_t& integers() const
+    {
+        return load().m_integers;
+    }
+    [[nodiscard]] const floats_t& floats() const { return load().m_floats; }
+    [[nodiscard]] const blobs_t& blobs() const { return load().m_blobs; }
+    [[nodiscard]] const data_t& data() const { return load().m_data; }
 
-    [[nodiscard]] strings_t& strings() { return m_strings; }
-    [[nodiscard]] integers_t& integers() { return m_integers; }
-    [[nodiscard]] floats_t& floats() { return m_floats; }
-    [[nodiscard]] blobs_t& blobs() { return m_blobs; }
-    [[nodiscard]] data_t& data() { return m_data; }
+    [[nodiscard]] strings_t& strings() { return load().m_strings; }
+    [[nodiscard]] integers_t& integers() { return load().m_integers; }
+    [[nodiscard]] floats_t& floats() { return load().m_floats; }
+    [[nodiscard]] blobs_t& blobs() { return load().m_blobs; }
+    [[nodiscard]] data_t& data() { return load().m_data; }
 
     [[nodiscard]] std::string
     getString(const std::string& name,
               const std::string& defaultValue = "") const
     {
-        if (m_strings.find(name) != m_strings.end())
+        const auto& strings = this->strings();
+        auto it = strings.find(name);
+        if (it != strings.end())
         {
-            return m_strings.at(name);
+            return it->second;
         }
         return defaultValue;
     }
 
     [[nodiscard]] int64_t getInteger(const std::string& name) const
     {
-        return m_integers.at(name);
+        return integers().at(name);
     }
 
     [[nodiscard]] double getDouble(const std::string& name) const
     {
-        return m_floats.at(name);
+        return floats().at(name);
     }
 
     [[nodiscard]] const std::vector<std::shared_ptr<E57Node>>& children() const
     {
-        return m_children;
+        return load().m_children;
     }
 
-    [[nodiscard]] size_t childCount() const { return m_children.size(); }
+    [[nodiscard]] size_t childCount() const { return children().size(); }
 
     void addChild(const std::shared_ptr<E57Node>& node)
     {
-        m_children.push_back(node);
+        load().m_children.push_back(node);
+    }
+
+    /**
+     * Defers building the fields and children of the node. The loader is
+     * invoked once, on the first access to any of them. A loader which
+     * throws is kept and invoked again on the next access. Accessing the
+     * node runs the loader without synchronization, so a node with a pending
+     * loader must not be accessed from several threads at once.
+     */
+    void setLoader(loader_t loader) { m_loader = std::move(loader); }
+
+    /**
+     * @return False if the fields and children have not been built yet.
+     */
+    [[nodiscard]] bool isLoaded() const { return !m_loader; }
+
+protected:
+    /**
+     * Runs a pending loader. Nodes are always created non-const, the loader
+     * therefore may fill in the node from const accessors.
+     */
+    E57Node& load() const
+    {
+        auto& self = const_cast<E57Node&>(*this);
+        if (m_loader)
+        {
+            auto loader = std::move(self.m_loader);
+            self.m_loader = nullptr;
+            try
+            {
+                loader(self);
+            }
+            catch (...)
+            {
+                self.m_loader = std::move(loader);
+                throw;
+            }
+        }
+        return self;
     }
 
 private:
@@ -88,13 +136,22 @@ private:
     blobs_t m_blobs;
     data_t m_data;
     std::vector<std::shared_ptr<E57Node>> m_children;
+    loader_t m_loader;
 };
 
 class E57Data3D : public E57Node
 {
 public:
-    E57Pose& pose() { return m_pose; }
-    const E57Pose& pose() const { return m_pose; }
+    E57Pose& pose()
+    {
+        load();
+        return m_pose;
+    }
+    const E57Pose& pose() const
+    {
+        load();
+        return m_pose;
+    }
 
 private:
     E57Pose m_pose;
@@ -135,16 +192,19 @@ class E57Image2D : public E57Node
 public:
     const E57PinholeRepresentationPtr& pinholeRepresentation() const
     {
+        load();
         return m_pinholeRepresentation;
     }
 
     const E57SphericalRepresentationPtr& sphericalRepresentation() const
     {
+        load();
         return m_sphericalRepresentation;
     }
 
     const E57CylindricalRepresentationPtr& cylindricalRepresentation() const
     {
+        load();
         return m_cylindricalRepresentation;
     }
 
@@ -163,8 +223,16 @@ public:
         m_cylindricalRepresentation = std::move(repr);
     }
 
-    E57Pose& pose() { return m_pose; }
-    const E57Pose& pose() const { return m_pose; }
+    E57Pose& pose()
+    {
+        load();
+        return m_pose;
+    }
+    const E57Pose& pose() const
+    {
+        load();
+        return m_pose;
+    }
 
 private:
     E57PinholeRepresentationPtr m_pinholeRepresentation;
@@ -180,23 +248,61 @@ using E57Image2DPtr = std::shared_ptr<E57Image2D>;
 class E57Root : public E57Node
 {
 public:
+    using children_loader_t = std::function<void(E57Root& root)>;
+
     [[nodiscard]] const std::vector<E57Data3DPtr>& data3D() const
     {
-        return m_data3d;
+        return loadChildren().m_data3d;
     }
 
-    [[nodiscard]] std::vector<E57Data3DPtr>& data3D() { return m_data3d; }
+    [[nodiscard]] std::vector<E57Data3DPtr>& data3D()
+    {
+        return loadChildren().m_data3d;
+    }
 
     [[nodiscard]] const std::vector<E57Image2DPtr>& images2D() const
     {
-        return m_images2d;
+        return loadChildren().m_images2d;
+    }
+
+    [[nodiscard]] std::vector<E57Image2DPtr>& images2D()
+    {
+        return loadChildren().m_images2d;
     }
 
-    [[nodiscard]] std::vector<E57Image2DPtr>& images2D() { return m_images2d; }
+    /**
+     * Defers building the data3D and images2D lists until one of them is
+     * first accessed. Like setLoader, a loader which throws is kept.
+     */
+    void setChildrenLoader(children_loader_t loader)
+    {
+        m_childrenLoader = std::move(loader);
+    }
 
 private:
     std::vector<E57Data3DPtr> m_data3d;
     std::vector<E57Image2DPtr> m_images2d;
+    children_loader_t m_childrenLoader;
+
+    E57Root& loadChildren() const
+    {
+        auto& self = const_cast<E57Root&>(*this);
+        if (m_childrenLoader)
+        {
+            auto loader = std::move(self.m_childrenLoader);
+            self.m_childrenLoader = nullptr;
+            try
+            {
+                loader(self);
+            }
+            catch (...)
+            {
+                self.m_childrenLoader = std::move(loader);
+                throw;
+            }
+        }
+        return self;
+    }
 };
 
 using E57RootPtr = std::shared_ptr<E57Root>;
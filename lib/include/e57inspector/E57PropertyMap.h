@@ -0,0 +1,115 @@
+#ifndef E57INSPECTOR_E57PROPERTYMAP_H
+#define E57INSPECTOR_E57PROPERTYMAP_H
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+/**
+ * Interned property name. All keys with the same name share one string,
+ * which lives until the end of the process, so a key is a single pointer
+ * and equal keys compare by address.
+ */
+class E57Key
+{
+public:
+    explicit E57Key(std::string_view name) : m_name(&intern(name)) {}
+
+    [[nodiscard]] const std::string& str() const { return *m_name; }
+    operator const std::string&() const { return *m_name; }
+
+    bool operator==(const E57Key& other) const
+    {
+        return m_name == other.m_name;
+    }
+
+private:
+    const std::string* m_name;
+
+    static const std::string& intern(std::string_view name);
+};
+
+/**
+ * Small map of node properties, stored as a vector of key value pairs sorted
+ * by name. Lookups are binary searches without allocations or hashing.
+ * Offers the subset of the std::unordered_map interface used on nodes.
+ */
+template <typename T> class E57PropertyMap
+{
+public:
+    using key_type = std::string;
+    using mapped_type = T;
+    using value_type = std::pair<E57Key, T>;
+    using iterator = typename std::vector<value_type>::iterator;
+    using const_iterator = typename std::vector<value_type>::const_iterator;
+
+    [[nodiscard]] iterator begin() { return m_properties.begin(); }
+    [[nodiscard]] iterator end() { return m_properties.end(); }
+    [[nodiscard]] const_iterator begin() const { return m_properties.begin(); }
+    [[nodiscard]] const_iterator end() const { return m_properties.end(); }
+
+    [[nodiscard]] size_t size() const { return m_properties.size(); }
+    [[nodiscard]] bool empty() const { return m_properties.empty(); }
+
+    [[nodiscard]] iterator find(std::string_view name)
+    {
+        auto it = lowerBound(name);
+        return it != end() && it->first.str() == name ? it : end();
+    }
+
+    [[nodiscard]] const_iterator find(std::string_view name) const
+    {
+        return const_cast<E57PropertyMap*>(this)->find(name);
+    }
+
+    [[nodiscard]] bool contains(std::string_view name) const
+    {
+        return find(name) != end();
+    }
+
+    [[nodiscard]] T& at(std::string_view name)
+    {
+        auto it = find(name);
+        if (it == end())
+        {
+            throw std::out_of_range("Property " + std::string(name) +
+                                    " not found.");
+        }
+        return it->second;
+    }
+
+    [[nodiscard]] const T& at(std::string_view name) const
+    {
+        return const_cast<E57PropertyMap*>(this)->at(name);
+    }
+
+    /**
+     * @return Value of the property, inserted with a default value if the
+     * map does not contain it yet.
+     */
+    T& operator[](std::string_view name)
+    {
+        auto it = lowerBound(name);
+        if (it == end() || it->first.str() != name)
+        {
+            it = m_properties.emplace(it, E57Key(name), T{});
+        }
+        return it->second;
+    }
+
+private:
+    std::vector<value_type> m_properties;
+
+    iterator lowerBound(std::string_view name)
+    {
+        return std::lower_bound(m_properties.begin(), m_properties.end(), name,
+                                [](const value_type& property,
+                                   std::string_view name)
+                                { return property.first.str() < name; });
+    }
+};
+
+#endif // E57INSPECTOR_E57PROPERTYMAP_H
@@ -1,8 +1,12 @@
 #ifndef E57INSPECTOR_E57READER_H
 #define E57INSPECTOR_E57READER_H
 
+#include <functional>
+#include <optional>
+#include <span>
 #include <string>
 
+#include "E57ColumnStats.h"
 #include "E57Node.h"
 
 enum class E57DataType
@@ -20,19 +24,119 @@ struct E57DataInfo
     double maxValue;
 };
 
+struct E57ReaderOptions
+{
+    /**
+     * Builds the data3D and images2D lists of the root and the fields and
+     * children of every node on first access instead of when the file is
+     * opened. Blob and data ids are assigned as the nodes are built. Nodes
+     * which are first accessed after the reader has been destroyed throw a
+     * runtime exception. Building a node is not synchronized, so a lazy tree
+     * must only be accessed from one thread at a time.
+     */
+    bool lazy = false;
+
+    /**
+     * Opens the file from its sidecar index <filename>.e57idx if the index
+     * matches the size and modification time of the file, without parsing
+     * the XML section. The file itself is opened once data or blobs are read.
+     * Otherwise the file is parsed completely, even in lazy mode, and the
+     * index is written next to it. Column statistics are kept next to the
+     * file as well, in <filename>.e57stats.
+     */
+    bool useIndex = false;
+};
+
 class E57ReaderImpl;
 class E57DataReader;
 class E57Reader
 {
 public:
-    explicit E57Reader(const std::string& filename);
+    using DecodeCallback =
+        std::function<void(uint32_t dataId, E57DataReader& dataReader)>;
+
+    explicit E57Reader(const std::string& filename,
+                       const E57ReaderOptions& options = {});
     ~E57Reader();
 
     [[nodiscard]] const E57RootPtr& root() const;
     [[nodiscard]] std::vector<uint8_t> blobData(uint32_t blobId) const;
+
+    /**
+     * @return Size of the blob in bytes.
+     */
+    [[nodiscard]] uint64_t blobSize(uint32_t blobId) const;
+
+    /**
+     * Reads a byte range of a blob into a caller-owned buffer.
+     * @param blobId Id of the blob.
+     * @param offset Byte offset into the blob.
+     * @param buffer Destination, at most buffer.size() bytes are read.
+     * @return Number of bytes read. Less than buffer.size() if the range
+     * extends beyond the end of the blob, 0 at the end.
+     */
+    uint64_t readBlob(uint32_t blobId, uint64_t offset,
+                      std::span<uint8_t> buffer) const;
     [[nodiscard]] std::vector<E57DataInfo> dataInfo(uint32_t dataId) const;
+
+    /**
+     * @return Number of records of a compressed vector. Unlike
+     * dataReader(dataId).recordCount(), the file is not opened if the reader
+     * was created from an index.
+     */
+    [[nodiscard]] uint64_t recordCount(uint32_t dataId) const;
     [[nodiscard]] E57DataReader dataReader(uint32_t dataId) const;
-    [[nodiscard]] std::string dumpXML(int indent = 4) const;
+
+    /**
+     * Computes statistics of columns of a compressed vector. All columns
+     * which are not cached yet are computed in a single decode pass. The
+     * results are cached per reader and stored next to the file if the
+     * reader uses an index.
+     * @param dataId Id of the compressed vector.
+     * @param columns Field names. Fields the prototype does not define are
+     * skipped.
+     * @return Statistics of the defined columns, in the requested order.
+     */
+    [[nodiscard]] std::vector<E57ColumnStats>
+    columnStats(uint32_t dataId, const std::vector<std::string>& columns) const;
+
+    /**
+     * @return Cached statistics of a column, without decoding anything.
+     */
+    [[nodiscard]] std::optional<E57ColumnStats>
+    cachedColumnStats(uint32_t dataId, const std::string& column) const;
+
+    /**
+     * Adds statistics which were accumulated while decoding a column
+     * elsewhere to the cache.
+     */
+    void setColumnStats(uint32_t dataId, const E57ColumnStats& stats) const;
+
+    /**
+     * Decodes several compressed vectors in parallel. Every worker thread
+     * opens its own read-only handle of the file and invokes the callback
+     * with a data reader for each data id it picks up. The callback binds
+     * its buffers and reads the data; it is called concurrently from
+     * different threads. The data reader must not be used after the callback
+     * returns.
+     * If a callback throws, the remaining scans are skipped and the first
+     * exception is rethrown once all workers have finished.
+     * @param dataIds Ids of the compressed vectors to decode.
+     * @param threads Number of worker threads, 0 for one per core.
+     * @param callback Invoked once per data id from a worker thread.
+     */
+    void decodeScans(const std::vector<uint32_t>& dataIds, uint32_t threads,
+                     const DecodeCallback& callback) const;
+
+    /**
+     * Returns the raw XML section of the file.
+     * @param indent Unused, the XML is returned as stored.
+     * @param verifyChecksums If true, the CRC-32C checksum of every page of
+     * the XML section is verified and a runtime exception is thrown on
+     * mismatch.
+     */
+    [[nodiscard]] std::string dumpXML(int indent = 4,
+                                      bool verifyChecksums = false) const;
 
 private:
     E57ReaderImpl* m_impl;
@@ -63,8 +167,28 @@ public:
     void bindBuffer(const std::string& identifier, uint32_t* buffer,
                     uint32_t bufferSize, uint32_t stride = sizeof(uint32_t));
 
+    /**
+     * @return True if the prototype of the compressed vector defines the
+     * field. Binding a buffer to an undefined field is a no-op.
+     */
+    [[nodiscard]] bool hasField(const std::string& identifier) const;
+
+    /**
+     * Reads the next batch of records into the bound buffers.
+     * @return Number of records read, 0 if there are no more records.
+     */
     uint64_t read();
 
+    /**
+     * @return Index of the record the next read() starts at.
+     */
+    [[nodiscard]] uint64_t position() const;
+
+    /**
+     * @return Total number of records of the compressed vector.
+     */
+    [[nodiscard]] uint64_t recordCount() const;
+
     friend class E57Reader;
 
 private:
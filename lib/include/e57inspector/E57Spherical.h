@@ -0,0 +1,32 @@
+#ifndef E57INSPECTOR_E57SPHERICAL_H
+#define E57INSPECTOR_E57SPHERICAL_H
+
+#include <array>
+#include <span>
+
+/**
+ * Converts spherical coordinates to cartesian coordinates in batches:
+ * x = r * cos(elevation) * cos(azimuth), y = r * cos(elevation) *
+ * sin(azimuth), z = r * sin(elevation).
+ * Sine and cosine are evaluated together with the single precision Cephes
+ * polynomials, eight (AVX2) or four (SSE2) points at a time. The remaining
+ * points and builds without SIMD use the standard library. The maximum
+ * error is a few ulp for angles below 8192 radians. A runtime exception is
+ * thrown if the sizes do not match.
+ * @param range Distance from the origin.
+ * @param elevation Elevation in radians.
+ * @param azimuth Azimuth in radians.
+ * @param xyz Cartesian coordinates, as many as there are ranges.
+ */
+void sphericalToCartesian(std::span<const float> range,
+                          std::span<const float> elevation,
+                          std::span<const float> azimuth,
+                          std::span<std::array<float, 3>> xyz);
+
+/**
+ * @return Instruction set used by sphericalToCartesian, "avx2", "sse2" or
+ * "scalar".
+ */
+[[nodiscard]] const char* sphericalToCartesianInstructionSet();
+
+#endif // E57INSPECTOR_E57SPHERICAL_H
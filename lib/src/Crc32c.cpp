@@ -0,0 +1,120 @@
+#include "Crc32c.h"
+
+#include <array>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <nmmintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#define E57INSPECTOR_CRC32C_X86
+#endif
+
+namespace
+{
+constexpr uint32_t CRC32C_POLYNOMIAL = 0x82F63B78; // reflected Castagnoli
+
+using Crc32cTable = std::array<std::array<uint32_t, 256>, 8>;
+
+constexpr Crc32cTable makeTable()
+{
+    Crc32cTable table{};
+    for (uint32_t i = 0; i < 256; ++i)
+    {
+        uint32_t crc = i;
+        for (int bit = 0; bit < 8; ++bit)
+        {
+            crc = (crc & 1) ? (crc >> 1) ^ CRC32C_POLYNOMIAL : crc >> 1;
+        }
+        table[0][i] = crc;
+    }
+    for (uint32_t i = 0; i < 256; ++i)
+    {
+        for (size_t slice = 1; slice < 8; ++slice)
+        {
+            uint32_t previous = table[slice - 1][i];
+            table[slice][i] = (previous >> 8) ^ table[0][previous & 0xFF];
+        }
+    }
+    return table;
+}
+
+constexpr Crc32cTable TABLE = makeTable();
+
+uint32_t crc32cTable(uint32_t crc, const uint8_t* data, size_t size)
+{
+    while (size >= 8)
+    {
+        uint64_t word;
+        std::memcpy(&word, data, sizeof(word));
+        word ^= crc;
+        crc = TABLE[7][word & 0xFF] ^ TABLE[6][(word >> 8) & 0xFF] ^
+              TABLE[5][(word >> 16) & 0xFF] ^ TABLE[4][(word >> 24) & 0xFF] ^
+              TABLE[3][(word >> 32) & 0xFF] ^ TABLE[2][(word >> 40) & 0xFF] ^
+              TABLE[1][(word >> 48) & 0xFF] ^ TABLE[0][word >> 56];
+        data += 8;
+        size -= 8;
+    }
+    while (size > 0)
+    {
+        crc = (crc >> 8) ^ TABLE[0][(crc ^ *data) & 0xFF];
+        ++data;
+        --size;
+    }
+    return crc;
+}
+
+#ifdef E57INSPECTOR_CRC32C_X86
+#if defined(__GNUC__) && !defined(__SSE4_2__)
+__attribute__((target("sse4.2")))
+#endif
+uint32_t
+crc32cHardware(uint32_t crc, const uint8_t* data, size_t size)
+{
+    uint64_t crc64 = crc;
+    while (size >= 8)
+    {
+        uint64_t word;
+        std::memcpy(&word, data, sizeof(word));
+        crc64 = _mm_crc32_u64(crc64, word);
+        data += 8;
+        size -= 8;
+    }
+    crc = static_cast<uint32_t>(crc64);
+    while (size > 0)
+    {
+        crc = _mm_crc32_u8(crc, *data);
+        ++data;
+        --size;
+    }
+    return crc;
+}
+
+bool hasHardwareCrc32c()
+{
+#if defined(__SSE4_2__)
+    return true;
+#elif defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    return (info[2] & (1 << 20)) != 0;
+#else
+    return __builtin_cpu_supports("sse4.2");
+#endif
+}
+#endif
+} // namespace
+
+uint32_t crc32c(const void* data, size_t size)
+{
+    const auto* bytes = static_cast<const uint8_t*>(data);
+#ifdef E57INSPECTOR_CRC32C_X86
+    static const bool hardware = hasHardwareCrc32c();
+    if (hardware)
+    {
+        return ~crc32cHardware(0xFFFFFFFF, bytes, size);
+    }
+#endif
+    return ~crc32cTable(0xFFFFFFFF, bytes, size);
+}
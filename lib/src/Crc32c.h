@@ -0,0 +1,18 @@
+#ifndef E57INSPECTOR_CRC32C_H
+#define E57INSPECTOR_CRC32C_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Computes the CRC-32C (Castagnoli) checksum of the given buffer, as used by
+ * the E57 page checksums. Uses the SSE4.2 crc32 instruction if the CPU
+ * supports it and falls back to a slicing-by-8 table implementation
+ * otherwise.
+ * @param data Pointer to the first byte.
+ * @param size Number of bytes.
+ * @return CRC-32C checksum
+ */
+uint32_t crc32c(const void* data, size_t size);
+
+#endif // E57INSPECTOR_CRC32C_H
@@ -0,0 +1,234 @@
+#include <e57inspector/E57ColumnStats.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define E57INSPECTOR_STATS_SSE2
+#endif
+
+namespace
+{
+constexpr size_t BINS = E57ColumnStats::HISTOGRAM_BINS;
+
+struct Reduction
+{
+    double min = std::numeric_limits<double>::infinity();
+    double max = -std::numeric_limits<double>::infinity();
+    double sum = 0.0;
+};
+
+template <typename T>
+void reduceScalar(Reduction& result, const T* values, size_t size)
+{
+    for (size_t i = 0; i < size; ++i)
+    {
+        double value = values[i];
+        result.min = std::min(result.min, value);
+        result.max = std::max(result.max, value);
+        result.sum += value;
+    }
+}
+
+Reduction reduce(std::span<const float> values)
+{
+    Reduction result;
+    size_t i = 0;
+#ifdef E57INSPECTOR_STATS_SSE2
+    if (values.size() >= 4)
+    {
+        __m128 min = _mm_set1_ps(std::numeric_limits<float>::infinity());
+        __m128 max = _mm_set1_ps(-std::numeric_limits<float>::infinity());
+        // the sum is accumulated in double precision
+        __m128d sumLow = _mm_setzero_pd();
+        __m128d sumHigh = _mm_setzero_pd();
+        for (; i + 4 <= values.size(); i += 4)
+        {
+            __m128 v = _mm_loadu_ps(values.data() + i);
+            min = _mm_min_ps(min, v);
+            max = _mm_max_ps(max, v);
+            sumLow = _mm_add_pd(sumLow, _mm_cvtps_pd(v));
+            sumHigh = _mm_add_pd(sumHigh, _mm_cvtps_pd(_mm_movehl_ps(v, v)));
+        }
+
+        alignas(16) float mins[4];
+        alignas(16) float maxs[4];
+        alignas(16) double sums[2];
+        _mm_store_ps(mins, min);
+        _mm_store_ps(maxs, max);
+        _mm_store_pd(sums, _mm_add_pd(sumLow, sumHigh));
+        result.min = *std::min_element(mins, mins + 4);
+        result.max = *std::max_element(maxs, maxs + 4);
+        result.sum = sums[0] + sums[1];
+    }
+#endif
+    reduceScalar(result, values.data() + i, values.size() - i);
+    return result;
+}
+
+Reduction reduce(std::span<const double> values)
+{
+    Reduction result;
+    size_t i = 0;
+#ifdef E57INSPECTOR_STATS_SSE2
+    if (values.size() >= 2)
+    {
+        __m128d min = _mm_set1_pd(std::numeric_limits<double>::infinity());
+        __m128d max = _mm_set1_pd(-std::numeric_limits<double>::infinity());
+        __m128d sum = _mm_setzero_pd();
+        for (; i + 2 <= values.size(); i += 2)
+        {
+            __m128d v = _mm_loadu_pd(values.data() + i);
+            min = _mm_min_pd(min, v);
+            max = _mm_max_pd(max, v);
+            sum = _mm_add_pd(sum, v);
+        }
+
+        alignas(16) double mins[2];
+        alignas(16) double maxs[2];
+        alignas(16) double sums[2];
+        _mm_store_pd(mins, min);
+        _mm_store_pd(maxs, max);
+        _mm_store_pd(sums, sum);
+        result.min = std::min(mins[0], mins[1]);
+        result.max = std::max(maxs[0], maxs[1]);
+        result.sum = sums[0] + sums[1];
+    }
+#endif
+    reduceScalar(result, values.data() + i, values.size() - i);
+    return result;
+}
+} // namespace
+
+double E57ColumnStats::percentile(double p) const
+{
+    if (count == 0 || histogram.empty())
+        return 0.0;
+
+    const double binWidth =
+        (histogramMax - histogramMin) / static_cast<double>(histogram.size());
+    const double target = std::clamp(p, 0.0, 100.0) / 100.0 * count;
+
+    double cumulative = 0.0;
+    for (size_t i = 0; i < histogram.size(); ++i)
+    {
+        if (histogram[i] > 0 && cumulative + histogram[i] >= target)
+        {
+            double fraction = (target - cumulative) / histogram[i];
+            double value = histogramMin + (i + fraction) * binWidth;
+            return std::clamp(value, minValue, maxValue);
+        }
+        cumulative += histogram[i];
+    }
+    return maxValue;
+}
+
+E57ColumnStatsAccumulator::E57ColumnStatsAccumulator()
+    : m_min(std::numeric_limits<double>::infinity()),
+      m_max(-std::numeric_limits<double>::infinity())
+{
+}
+
+void E57ColumnStatsAccumulator::add(std::span<const float> values)
+{
+    Reduction reduction = reduce(values);
+    add(values, reduction.min, reduction.max, reduction.sum);
+}
+
+void E57ColumnStatsAccumulator::add(std::span<const double> values)
+{
+    Reduction reduction = reduce(values);
+    add(values, reduction.min, reduction.max, reduction.sum);
+}
+
+template <typename T>
+void E57ColumnStatsAccumulator::add(std::span<const T> values, double min,
+                                    double max, double sum)
+{
+    if (values.empty())
+        return;
+
+    // min and max skip NaN, the sum does not
+    if (!std::isfinite(min) || !std::isfinite(max) || std::isnan(sum))
+    {
+        throw std::runtime_error(
+            "Cannot compute statistics of non-finite values.");
+    }
+
+    extendHistogram(min, max);
+
+    const double invBinWidth = 1.0 / m_binWidth;
+    for (T value : values)
+    {
+        double bin = (value - m_histogramMin) * invBinWidth;
+        size_t index = !(bin > 0.0)       ? 0
+                       : bin >= BINS - 1 ? BINS - 1
+                                         : static_cast<size_t>(bin);
+        ++m_histogram[index];
+    }
+
+    m_min = std::min(m_min, min);
+    m_max = std::max(m_max, max);
+    m_sum += sum;
+    m_count += values.size();
+}
+
+void E57ColumnStatsAccumulator::extendHistogram(double min, double max)
+{
+    if (m_histogram.empty())
+    {
+        m_histogram.resize(BINS);
+        m_histogramMin = min;
+        m_binWidth = (max - min) / BINS;
+        if (m_binWidth <= 0.0)
+        {
+            m_binWidth = std::max(std::abs(min), 1.0) / BINS;
+        }
+        return;
+    }
+
+    // double the range until it covers [min, max], merging pairs of bins
+    while (min < m_histogramMin || max > m_histogramMin + m_binWidth * BINS)
+    {
+        std::vector<uint64_t> merged(BINS);
+        if (min < m_histogramMin)
+        {
+            // extend to the left, the old bins end up in the upper half
+            for (size_t i = 0; i < BINS; ++i)
+            {
+                merged[BINS / 2 + i / 2] += m_histogram[i];
+            }
+            m_histogramMin -= m_binWidth * BINS;
+        }
+        else
+        {
+            for (size_t i = 0; i < BINS; ++i)
+            {
+                merged[i / 2] += m_histogram[i];
+            }
+        }
+        m_binWidth *= 2.0;
+        m_histogram = std::move(merged);
+    }
+}
+
+E57ColumnStats
+E57ColumnStatsAccumulator::result(const std::string& identifier) const
+{
+    E57ColumnStats result;
+    result.identifier = identifier;
+    result.count = m_count;
+    if (m_count == 0)
+        return result;
+
+    result.minValue = m_min;
+    result.maxValue = m_max;
+    result.mean = m_sum / static_cast<double>(m_count);
+    result.histogramMin = m_histogramMin;
+    result.histogramMax = m_histogramMin + m_binWidth * BINS;
+    result.histogram = m_histogram;
+    return result;
+}
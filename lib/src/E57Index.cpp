@@ -0,0 +1,525 @@
+#include "E57Index.h"
+
+#include <array>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <type_traits>
+
+namespace
+{
+constexpr std::array<char, 8> INDEX_MAGIC = {'E', '5', '7', 'I',
+                                             'N', 'D', 'E', 'X'};
+constexpr uint32_t INDEX_VERSION = 3;
+constexpr std::array<char, 8> STATS_MAGIC = {'E', '5', '7', 'S',
+                                             'T', 'A', 'T', 'S'};
+constexpr uint32_t STATS_VERSION = 1;
+
+struct FileKey
+{
+    uint64_t size;
+    int64_t modificationTime;
+};
+
+FileKey fileKey(const std::string& filename)
+{
+    return {std::filesystem::file_size(filename),
+            static_cast<int64_t>(std::filesystem::last_write_time(filename)
+                                     .time_since_epoch()
+                                     .count())};
+}
+
+class IndexWriter
+{
+public:
+    explicit IndexWriter(std::ofstream& ofs) : m_ofs(ofs) {}
+
+    template <typename T>
+        requires std::is_arithmetic_v<T>
+    void write(T value)
+    {
+        m_ofs.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    void write(const std::string& value)
+    {
+        write<uint64_t>(value.size());
+        m_ofs.write(value.data(), static_cast<std::streamsize>(value.size()));
+    }
+
+    template <typename Map> void writeMap(const Map& map)
+    {
+        write<uint64_t>(map.size());
+        for (const auto& [key, value] : map)
+        {
+            write(key);
+            write(value);
+        }
+    }
+
+    void write(const E57Node& node)
+    {
+        write(node.name());
+        writeMap(node.strings());
+        writeMap(node.integers());
+        writeMap(node.floats());
+        writeMap(node.blobs());
+        writeMap(node.data());
+        write<uint64_t>(node.children().size());
+        for (const auto& child : node.children())
+        {
+            write(*child);
+        }
+    }
+
+    void write(const E57Pose& pose)
+    {
+        for (double value : pose.translation)
+        {
+            write(value);
+        }
+        write(pose.rotation.x);
+        write(pose.rotation.y);
+        write(pose.rotation.z);
+        write(pose.rotation.w);
+    }
+
+    void writeOptional(const E57NodePtr& node)
+    {
+        write<uint8_t>(node ? 1 : 0);
+        if (node)
+        {
+            write(*node);
+        }
+    }
+
+    void write(const E57ColumnStats& stats)
+    {
+        write(stats.identifier);
+        write(stats.count);
+        write(stats.minValue);
+        write(stats.maxValue);
+        write(stats.mean);
+        write(stats.histogramMin);
+        write(stats.histogramMax);
+        write<uint64_t>(stats.histogram.size());
+        for (uint64_t bin : stats.histogram)
+        {
+            write(bin);
+        }
+    }
+
+private:
+    std::ofstream& m_ofs;
+};
+
+class IndexReader
+{
+public:
+    IndexReader(std::ifstream& ifs, uint64_t size) : m_ifs(ifs), m_size(size)
+    {
+    }
+
+    template <typename T>
+        requires std::is_arithmetic_v<T>
+    T read()
+    {
+        T value;
+        m_ifs.read(reinterpret_cast<char*>(&value), sizeof(T));
+        return value;
+    }
+
+    std::string readString()
+    {
+        std::string value(readCount(), '\0');
+        m_ifs.read(value.data(), static_cast<std::streamsize>(value.size()));
+        return value;
+    }
+
+    template <typename Map> void readMap(Map& map)
+    {
+        using value_t = typename Map::mapped_type;
+        uint64_t count = readCount();
+        for (uint64_t i = 0; i < count; ++i)
+        {
+            std::string key = readString();
+            if constexpr (std::is_same_v<value_t, std::string>)
+            {
+                map[key] = readString();
+            }
+            else
+            {
+                map[key] = read<value_t>();
+            }
+        }
+    }
+
+    template <typename T = E57Node> std::shared_ptr<T> readNode()
+    {
+        auto node = std::make_shared<T>();
+        readNode(*node);
+        return node;
+    }
+
+    void readNode(E57Node& node)
+    {
+        node.setName(readString());
+        readMap(node.strings());
+        readMap(node.integers());
+        readMap(node.floats());
+        readMap(node.blobs());
+        readMap(node.data());
+        uint64_t childCount = readCount();
+        for (uint64_t i = 0; i < childCount; ++i)
+        {
+            node.addChild(readNode());
+        }
+    }
+
+    E57Pose readPose()
+    {
+        E57Pose pose{};
+        for (double& value : pose.translation)
+        {
+            value = read<double>();
+        }
+        pose.rotation.x = read<double>();
+        pose.rotation.y = read<double>();
+        pose.rotation.z = read<double>();
+        pose.rotation.w = read<double>();
+        return pose;
+    }
+
+    template <typename T> std::shared_ptr<T> readOptional()
+    {
+        if (read<uint8_t>() == 0)
+        {
+            return nullptr;
+        }
+        return readNode<T>();
+    }
+
+    E57ColumnStats readColumnStats()
+    {
+        E57ColumnStats stats;
+        stats.identifier = readString();
+        stats.count = read<uint64_t>();
+        stats.minValue = read<double>();
+        stats.maxValue = read<double>();
+        stats.mean = read<double>();
+        stats.histogramMin = read<double>();
+        stats.histogramMax = read<double>();
+        stats.histogram.resize(readCount());
+        for (auto& bin : stats.histogram)
+        {
+            bin = read<uint64_t>();
+        }
+        return stats;
+    }
+
+    /**
+     * Reads an element count. Counts larger than the rest of the index
+     * can only stem from a corrupt index.
+     */
+    uint64_t readCount()
+    {
+        auto count = read<uint64_t>();
+        if (count > m_size - static_cast<uint64_t>(m_ifs.tellg()))
+        {
+            throw std::runtime_error("Corrupt index.");
+        }
+        return count;
+    }
+
+private:
+    std::ifstream& m_ifs;
+    uint64_t m_size;
+};
+
+// serializes the writes of all readers of the process
+std::mutex& writeMutex()
+{
+    static std::mutex mutex;
+    return mutex;
+}
+
+/**
+ * Writes a file through a temporary file next to it, which is then renamed.
+ * Every write uses a temporary file of its own, so concurrent writes never
+ * mix.
+ */
+bool writeFile(const std::string& path,
+               const std::function<void(std::ofstream&)>& write)
+{
+    static std::atomic<uint64_t> counter{0};
+    const std::string tempPath = path + "." +
+                                 std::to_string(std::random_device{}()) +
+                                 "-" + std::to_string(counter++) + ".tmp";
+    try
+    {
+        {
+            std::ofstream ofs(tempPath, std::ios::binary | std::ios::trunc);
+            ofs.exceptions(std::ios::failbit | std::ios::badbit);
+            write(ofs);
+        }
+        std::filesystem::rename(tempPath, path);
+        return true;
+    }
+    catch (...)
+    {
+        std::error_code error;
+        std::filesystem::remove(tempPath, error);
+        return false;
+    }
+}
+
+/**
+ * Opens a file written by writeFile and checks its header.
+ * @return False if the file is missing, has a different format or version
+ * or does not belong to the size and modification time of the E57 file.
+ */
+bool openFile(std::ifstream& ifs, const std::string& path,
+              const std::string& filename, const std::array<char, 8>& magic,
+              uint32_t version)
+{
+    if (!std::filesystem::exists(path))
+    {
+        return false;
+    }
+
+    ifs.open(path, std::ios::binary);
+    ifs.exceptions(std::ios::failbit | std::ios::badbit);
+
+    std::array<char, 8> fileMagic{};
+    ifs.read(fileMagic.data(), fileMagic.size());
+    uint32_t fileVersion;
+    ifs.read(reinterpret_cast<char*>(&fileVersion), sizeof(fileVersion));
+    if (fileMagic != magic || fileVersion != version)
+    {
+        return false;
+    }
+
+    FileKey key = fileKey(filename);
+    FileKey stored{};
+    ifs.read(reinterpret_cast<char*>(&stored.size), sizeof(stored.size));
+    ifs.read(reinterpret_cast<char*>(&stored.modificationTime),
+             sizeof(stored.modificationTime));
+    return stored.size == key.size &&
+           stored.modificationTime == key.modificationTime;
+}
+
+void writeHeader(IndexWriter& writer, std::ofstream& ofs,
+                 const std::string& filename,
+                 const std::array<char, 8>& magic, uint32_t version)
+{
+    FileKey key = fileKey(filename);
+    ofs.write(magic.data(), magic.size());
+    writer.write(version);
+    writer.write(key.size);
+    writer.write(key.modificationTime);
+}
+} // namespace
+
+std::string E57Index::indexPath(const std::string& filename)
+{
+    return filename + ".e57idx";
+}
+
+std::optional<E57Index> E57Index::load(const std::string& filename)
+{
+    try
+    {
+        const std::string path = indexPath(filename);
+        std::ifstream ifs;
+        if (!openFile(ifs, path, filename, INDEX_MAGIC, INDEX_VERSION))
+        {
+            return std::nullopt;
+        }
+        IndexReader reader(ifs, std::filesystem::file_size(path));
+
+        E57Index index;
+        index.guid = reader.readString();
+
+        index.blobs.resize(reader.readCount());
+        for (auto& blob : index.blobs)
+        {
+            blob.path = reader.readString();
+            blob.size = reader.read<uint64_t>();
+        }
+
+        index.data.resize(reader.readCount());
+        for (auto& data : index.data)
+        {
+            data.path = reader.readString();
+            data.recordCount = reader.read<uint64_t>();
+            data.dataInfo.resize(reader.readCount());
+            for (auto& info : data.dataInfo)
+            {
+                info.identifier = reader.readString();
+                info.dataType =
+                    static_cast<E57DataType>(reader.read<uint8_t>());
+                info.minValue = reader.read<double>();
+                info.maxValue = reader.read<double>();
+            }
+        }
+
+        index.root = reader.readNode<E57Root>();
+
+        uint64_t data3DCount = reader.readCount();
+        for (uint64_t i = 0; i < data3DCount; ++i)
+        {
+            auto data3D = reader.readNode<E57Data3D>();
+            data3D->pose() = reader.readPose();
+            index.root->data3D().push_back(data3D);
+        }
+
+        uint64_t images2DCount = reader.readCount();
+        for (uint64_t i = 0; i < images2DCount; ++i)
+        {
+            auto image2D = reader.readNode<E57Image2D>();
+            image2D->pose() = reader.readPose();
+            image2D->setPinholeRepresentation(
+                reader.readOptional<E57PinholeRepresentation>());
+            image2D->setSphericalRepresentation(
+                reader.readOptional<E57SphericalRepresentation>());
+            image2D->setCylindricalRepresentation(
+                reader.readOptional<E57CylindricalRepresentation>());
+            index.root->images2D().push_back(image2D);
+        }
+
+        return index;
+    }
+    catch (...)
+    {
+        // an unreadable index is rebuilt from the file
+        return std::nullopt;
+    }
+}
+
+bool E57Index::save(const std::string& filename) const
+{
+    std::lock_guard lock(writeMutex());
+    return writeFile(
+        indexPath(filename),
+        [this, &filename](std::ofstream& ofs)
+        {
+            IndexWriter writer(ofs);
+            writeHeader(writer, ofs, filename, INDEX_MAGIC, INDEX_VERSION);
+            writer.write(guid);
+
+            writer.write<uint64_t>(blobs.size());
+            for (const auto& blob : blobs)
+            {
+                writer.write(blob.path);
+                writer.write(blob.size);
+            }
+
+            writer.write<uint64_t>(data.size());
+            for (const auto& item : data)
+            {
+                writer.write(item.path);
+                writer.write(item.recordCount);
+                writer.write<uint64_t>(item.dataInfo.size());
+                for (const auto& info : item.dataInfo)
+                {
+                    writer.write(info.identifier);
+                    writer.write(static_cast<uint8_t>(info.dataType));
+                    writer.write(info.minValue);
+                    writer.write(info.maxValue);
+                }
+            }
+
+            writer.write(static_cast<const E57Node&>(*root));
+
+            writer.write<uint64_t>(root->data3D().size());
+            for (const auto& data3D : root->data3D())
+            {
+                writer.write(static_cast<const E57Node&>(*data3D));
+                writer.write(data3D->pose());
+            }
+
+            writer.write<uint64_t>(root->images2D().size());
+            for (const auto& image2D : root->images2D())
+            {
+                writer.write(static_cast<const E57Node&>(*image2D));
+                writer.write(image2D->pose());
+                writer.writeOptional(image2D->pinholeRepresentation());
+                writer.writeOptional(image2D->sphericalRepresentation());
+                writer.writeOptional(image2D->cylindricalRepresentation());
+            }
+        });
+}
+
+std::string E57Index::columnStatsPath(const std::string& filename)
+{
+    return filename + ".e57stats";
+}
+
+E57Index::ColumnStats E57Index::loadColumnStats(const std::string& filename)
+{
+    ColumnStats result;
+    try
+    {
+        const std::string path = columnStatsPath(filename);
+        std::ifstream ifs;
+        if (!openFile(ifs, path, filename, STATS_MAGIC, STATS_VERSION))
+        {
+            return {};
+        }
+        IndexReader reader(ifs, std::filesystem::file_size(path));
+
+        uint64_t dataCount = reader.readCount();
+        for (uint64_t i = 0; i < dataCount; ++i)
+        {
+            auto& columns = result[reader.read<uint32_t>()];
+            uint64_t columnCount = reader.readCount();
+            for (uint64_t j = 0; j < columnCount; ++j)
+            {
+                auto stats = reader.readColumnStats();
+                columns[stats.identifier] = std::move(stats);
+            }
+        }
+        return result;
+    }
+    catch (...)
+    {
+        // unreadable statistics are computed again
+        return {};
+    }
+}
+
+bool E57Index::saveColumnStats(const std::string& filename,
+                               const ColumnStats& stats)
+{
+    std::lock_guard lock(writeMutex());
+    ColumnStats merged = loadColumnStats(filename);
+    for (const auto& [dataId, columns] : stats)
+    {
+        for (const auto& [identifier, columnStats] : columns)
+        {
+            merged[dataId][identifier] = columnStats;
+        }
+    }
+
+    return writeFile(
+        columnStatsPath(filename),
+        [&filename, &merged](std::ofstream& ofs)
+        {
+            IndexWriter writer(ofs);
+            writeHeader(writer, ofs, filename, STATS_MAGIC, STATS_VERSION);
+            writer.write<uint64_t>(merged.size());
+            for (const auto& [dataId, columns] : merged)
+            {
+                writer.write(dataId);
+                writer.write<uint64_t>(columns.size());
+                for (const auto& [identifier, columnStats] : columns)
+                {
+                    writer.write(columnStats);
+                }
+            }
+        });
+}
@@ -0,0 +1,92 @@
+#ifndef E57INSPECTOR_E57INDEX_H
+#define E57INSPECTOR_E57INDEX_H
+
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <e57inspector/E57Node.h>
+#include <e57inspector/E57Reader.h>
+
+/**
+ * Sidecar index of an E57 file, stored next to it as <filename>.e57idx. It
+ * holds everything the reader builds from the XML section, so a file can be
+ * reopened without parsing it. The index is keyed by the size and the
+ * modification time of the file; the GUID is checked once the file itself
+ * has to be opened. Column statistics are stored in a second file,
+ * <filename>.e57stats, which is rewritten on its own as statistics are
+ * added.
+ * The index is a local cache and stored in native byte order. Every write
+ * goes to a temporary file of its own, which is then renamed, so readers
+ * never see a partly written file.
+ */
+struct E57Index
+{
+    struct Blob
+    {
+        std::string path;
+        uint64_t size;
+    };
+
+    struct Data
+    {
+        std::string path;
+        uint64_t recordCount;
+        std::vector<E57DataInfo> dataInfo;
+    };
+
+    // statistics per data id and field name
+    using ColumnStats =
+        std::map<uint32_t, std::map<std::string, E57ColumnStats>>;
+
+    std::string guid;
+    E57RootPtr root;
+    std::vector<Blob> blobs;
+    std::vector<Data> data;
+
+    /**
+     * @return Path of the sidecar index of the given E57 file.
+     */
+    static std::string indexPath(const std::string& filename);
+
+    /**
+     * Loads the sidecar index of the given E57 file.
+     * @return The index, or nothing if there is no index, it has a different
+     * version or it does not match the size and modification time of the
+     * file.
+     */
+    static std::optional<E57Index> load(const std::string& filename);
+
+    /**
+     * Writes the sidecar index of the given E57 file.
+     * @return False if the index could not be written.
+     */
+    bool save(const std::string& filename) const;
+
+    /**
+     * @return Path of the column statistics of the given E57 file.
+     */
+    static std::string columnStatsPath(const std::string& filename);
+
+    /**
+     * Loads the column statistics stored for the given E57 file.
+     * @return The statistics, empty if there are none or they do not match
+     * the size and modification time of the file.
+     */
+    static ColumnStats loadColumnStats(const std::string& filename);
+
+    /**
+     * Adds column statistics to those stored for the given E57 file. The
+     * stored statistics are read and merged first, so readers of the same
+     * file keep each other's statistics. Writes within a process are
+     * serialized; between processes a concurrent write may be lost, the
+     * statistics are recomputed then.
+     * @return False if the statistics could not be written.
+     */
+    static bool saveColumnStats(const std::string& filename,
+                                const ColumnStats& stats);
+};
+
+#endif // E57INSPECTOR_E57INDEX_H
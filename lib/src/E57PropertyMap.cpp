@@ -0,0 +1,44 @@
+#include <e57inspector/E57PropertyMap.h>
+
+#include <mutex>
+#include <unordered_set>
+
+namespace
+{
+struct KeyHash
+{
+    using is_transparent = void;
+
+    size_t operator()(std::string_view name) const
+    {
+        return std::hash<std::string_view>{}(name);
+    }
+};
+
+struct KeyPool
+{
+    std::mutex mutex;
+    // node based, the addresses of the strings stay valid on rehash
+    std::unordered_set<std::string, KeyHash, std::equal_to<>> names;
+};
+
+KeyPool& keyPool()
+{
+    // never destroyed, keys may outlive static destruction
+    static auto* pool = new KeyPool();
+    return *pool;
+}
+} // namespace
+
+const std::string& E57Key::intern(std::string_view name)
+{
+    auto& pool = keyPool();
+    std::lock_guard<std::mutex> lock(pool.mutex);
+
+    auto it = pool.names.find(name);
+    if (it == pool.names.end())
+    {
+        it = pool.names.emplace(name).first;
+    }
+    return *it;
+}
@@ -2,8 +2,9 @@
 
 #include "E57ReaderImpl.h"
 
-E57Reader::E57Reader(const std::string& filename)
-    : m_impl{new E57ReaderImpl(filename)}
+E57Reader::E57Reader(const std::string& filename,
+                     const E57ReaderOptions& options)
+    : m_impl{new E57ReaderImpl(filename, options)}
 {
 }
 
@@ -22,19 +23,67 @@ std::vector<uint8_t> E57Reader::blobData(uint32_t blobId) const
     return m_impl->blobData(blobId);
 }
 
+uint64_t E57Reader::blobSize(uint32_t blobId) const
+{
+    return m_impl->blobSize(blobId);
+}
+
+uint64_t E57Reader::readBlob(uint32_t blobId, uint64_t offset,
+                             std::span<uint8_t> buffer) const
+{
+    return m_impl->readBlob(blobId, offset, buffer);
+}
+
 std::vector<E57DataInfo> E57Reader::dataInfo(uint32_t dataId) const
 {
     return m_impl->dataInfo(dataId);
 }
 
+uint64_t E57Reader::recordCount(uint32_t dataId) const
+{
+    return m_impl->recordCount(dataId);
+}
+
+std::vector<E57ColumnStats>
+E57Reader::columnStats(uint32_t dataId,
+                       const std::vector<std::string>& columns) const
+{
+    return m_impl->columnStats(dataId, columns);
+}
+
+std::optional<E57ColumnStats>
+E57Reader::cachedColumnStats(uint32_t dataId, const std::string& column) const
+{
+    return m_impl->cachedColumnStats(dataId, column);
+}
+
+void E57Reader::setColumnStats(uint32_t dataId,
+                               const E57ColumnStats& stats) const
+{
+    m_impl->setColumnStats(dataId, stats);
+}
+
 E57DataReader E57Reader::dataReader(uint32_t dataId) const
 {
     return E57DataReader(m_impl->dataReader(dataId));
 }
 
-std::string E57Reader::dumpXML(int indent) const
+void E57Reader::decodeScans(const std::vector<uint32_t>& dataIds,
+                            uint32_t threads,
+                            const DecodeCallback& callback) const
+{
+    m_impl->decodeScans(
+        dataIds, threads,
+        [&callback](uint32_t dataId, std::shared_ptr<E57DataReaderImpl> impl)
+        {
+            E57DataReader dataReader(std::move(impl));
+            callback(dataId, dataReader);
+        });
+}
+
+std::string E57Reader::dumpXML(int indent, bool verifyChecksums) const
 {
-    return m_impl->dumpXML(indent);
+    return m_impl->dumpXML(indent, verifyChecksums);
 }
 
 void E57DataReader::bindBuffer(const std::string& identifier, float* buffer,
@@ -91,7 +140,22 @@ void E57DataReader::bindBuffer(const std::string& identifier, uint32_t* buffer,
     m_impl->bindBuffer(identifier, buffer, bufferSize, stride);
 }
 
+bool E57DataReader::hasField(const std::string& identifier) const
+{
+    return m_impl->hasField(identifier);
+}
+
 uint64_t E57DataReader::read()
 {
     return m_impl->read();
 }
+
+uint64_t E57DataReader::position() const
+{
+    return m_impl->position();
+}
+
+uint64_t E57DataReader::recordCount() const
+{
+    return m_impl->recordCount();
+}
@@ -1,24 +1,86 @@
 #include "E57ReaderImpl.h"
 
+#include <algorithm>
+#include <atomic>
 #include <exception>
 #include <filesystem>
 #include <fstream>
+#include <mutex>
+#include <thread>
 #include <vector>
 
+#include "E57Index.h"
 #include "E57Utils.h"
 #include "PagedBinaryFileReader.h"
 
-void E57ReaderImpl::parseFields(E57NodePtr result,
-                                const e57::StructureNode& node,
-                                const std::set<std::string>& ignoreFields)
+// Opening and closing image files initializes and terminates Xerces, which is
+// not thread-safe. All image files are therefore opened and closed under this
+// mutex.
+static std::mutex& imageFileMutex()
+{
+    static std::mutex mutex;
+    return mutex;
+}
+
+static e57::ImageFile openImageFile(const std::string& filename)
 {
-    result->setName(node.elementName());
+    std::lock_guard<std::mutex> lock(imageFileMutex());
+    return {filename, "r"};
+}
 
+static void closeImageFile(e57::ImageFile& imageFile)
+{
+    std::lock_guard<std::mutex> lock(imageFileMutex());
+    imageFile.close();
+}
+
+// lazy nodes are built from the image file of their reader
+static void throwIfExpired(const std::weak_ptr<bool>& alive)
+{
+    if (alive.expired())
+    {
+        throw std::runtime_error(
+            "Cannot load node, its reader has been destroyed.");
+    }
+}
+
+static std::string nodeName(const e57::StructureNode& node)
+{
     if (node.isDefined("name"))
     {
-        result->setName(e57::StringNode(node.get("name")).value());
+        return e57::StringNode(node.get("name")).value();
+    }
+    return node.elementName();
+}
+
+template <typename T, typename U>
+std::shared_ptr<T> E57ReaderImpl::createNode(
+    const e57::StructureNode& node,
+    void (E57ReaderImpl::*parse)(U&, const e57::StructureNode&))
+{
+    auto result = std::make_shared<T>();
+    result->setName(nodeName(node));
+
+    if (!m_options.lazy)
+    {
+        (this->*parse)(*result, node);
+        return result;
     }
 
+    std::weak_ptr<bool> alive = m_alive;
+    result->setLoader(
+        [this, alive, node, parse](E57Node& target)
+        {
+            throwIfExpired(alive);
+            (this->*parse)(static_cast<T&>(target), node);
+        });
+    return result;
+}
+
+void E57ReaderImpl::parseFields(E57Node& result,
+                                const e57::StructureNode& node,
+                                const std::set<std::string>& ignoreFields)
+{
     for (int64_t i = 0; i < node.childCount(); ++i)
     {
         auto child = node.get(i);
@@ -28,113 +90,111 @@ void E57ReaderImpl::parseFields(E57NodePtr result,
         }
         if (child.type() == e57::TypeString)
         {
-            result->strings()[child.elementName()] =
+            result.strings()[child.elementName()] =
                 e57::StringNode(child).value();
         }
         else if (child.type() == e57::TypeInteger)
         {
-            result->integers()[child.elementName()] =
+            result.integers()[child.elementName()] =
                 e57::IntegerNode(child).value();
         }
         else if (child.type() == e57::TypeScaledInteger)
         {
-            result->integers()[child.elementName()] =
+            result.integers()[child.elementName()] =
                 e57::ScaledIntegerNode(child).rawValue();
         }
         else if (child.type() == e57::TypeFloat)
         {
-            result->floats()[child.elementName()] =
+            result.floats()[child.elementName()] =
                 e57::FloatNode(child).value();
         }
         else if (child.type() == e57::TypeStructure)
         {
-            auto item = std::make_shared<E57Node>();
-            parseFields(item, e57::StructureNode(child));
-            result->addChild(item);
+            result.addChild(createNode<E57Node>(
+                e57::StructureNode(child), &E57ReaderImpl::parseStructure));
         }
         else if (child.type() == e57::TypeBlob)
         {
             auto blob = e57::BlobNode(child);
             uint32_t blobId = registerBlob(blob);
-            result->blobs()[blob.elementName()] = blobId;
+            result.blobs()[blob.elementName()] = blobId;
         }
         else if (child.type() == e57::TypeCompressedVector)
         {
             auto compressedVectorNode = e57::CompressedVectorNode(child);
             std::string elementName = compressedVectorNode.elementName();
             elementName[0] = static_cast<char>(std::toupper(elementName[0]));
-            result->integers()["Num" + elementName] =
+            result.integers()["Num" + elementName] =
                 compressedVectorNode.childCount();
             uint32_t dataId = registerData(compressedVectorNode);
-            result->data()[compressedVectorNode.elementName()] = dataId;
+            result.data()[compressedVectorNode.elementName()] = dataId;
 
-            auto item = std::make_shared<E57Node>();
-            parseFields(item,
-                        e57::StructureNode(compressedVectorNode.prototype()));
+            auto item = createNode<E57Node>(
+                e57::StructureNode(compressedVectorNode.prototype()),
+                &E57ReaderImpl::parseStructure);
             item->setName(compressedVectorNode.elementName());
-            result->addChild(item);
+            result.addChild(item);
         }
     }
 }
 
-E57Data3DPtr E57ReaderImpl::parseData3D(const e57::StructureNode& node)
+void E57ReaderImpl::parseStructure(E57Node& result,
+                                   const e57::StructureNode& node)
 {
-    auto result = std::make_shared<E57Data3D>();
     parseFields(result, node);
-    result->pose() = parsePose(node);
-
-    return result;
 }
 
-E57Image2DPtr E57ReaderImpl::parseImage2D(const e57::StructureNode& node)
+void E57ReaderImpl::parseData3D(E57Data3D& result,
+                                const e57::StructureNode& node)
 {
-    auto result = std::make_shared<E57Image2D>();
+    parseFields(result, node);
+    result.pose() = parsePose(node);
+}
 
+void E57ReaderImpl::parseImage2D(E57Image2D& result,
+                                 const e57::StructureNode& node)
+{
     if (node.isDefined("pinholeRepresentation"))
     {
-        auto pinholeRepr = std::make_shared<E57PinholeRepresentation>();
-        parseFields(pinholeRepr,
-                    e57::StructureNode(node.get("pinholeRepresentation")));
-        result->setPinholeRepresentation(pinholeRepr);
+        result.setPinholeRepresentation(createNode<E57PinholeRepresentation>(
+            e57::StructureNode(node.get("pinholeRepresentation")),
+            &E57ReaderImpl::parseStructure));
     }
 
     if (node.isDefined("sphericalRepresentation"))
     {
-        auto sphericalRepr = std::make_shared<E57SphericalRepresentation>();
-        parseFields(sphericalRepr,
-                    e57::StructureNode(node.get("sphericalRepresentation")));
-        result->setSphericalRepresentation(sphericalRepr);
+        result.setSphericalRepresentation(
+            createNode<E57SphericalRepresentation>(
+                e57::StructureNode(node.get("sphericalRepresentation")),
+                &E57ReaderImpl::parseStructure));
     }
 
     if (node.isDefined("cylindricalRepresentation"))
     {
-        auto cylindricalRepr = std::make_shared<E57CylindricalRepresentation>();
-        parseFields(cylindricalRepr,
-                    e57::StructureNode(node.get("cylindricalRepresentation")));
-        result->setCylindricalRepresentation(cylindricalRepr);
+        result.setCylindricalRepresentation(
+            createNode<E57CylindricalRepresentation>(
+                e57::StructureNode(node.get("cylindricalRepresentation")),
+                &E57ReaderImpl::parseStructure));
     }
 
     parseFields(result, node,
                 {"pinholeRepresentation", "sphericalRepresentation",
                  "cylindricalRepresentation"});
 
-    result->pose() = parsePose(node);
-
-    return result;
+    result.pose() = parsePose(node);
 }
 
-E57RootPtr E57ReaderImpl::parseRoot(const e57::StructureNode& node)
+void E57ReaderImpl::parseRootChildren(E57Root& result,
+                                      const e57::StructureNode& node)
 {
-    auto result = std::make_shared<E57Root>();
-    parseFields(result, node);
-
     if (node.isDefined("data3D"))
     {
         auto vectorData3D = e57::VectorNode(node.get("data3D"));
         for (int64_t i = 0; i < vectorData3D.childCount(); ++i)
         {
-            result->data3D().emplace_back(
-                parseData3D(e57::StructureNode(vectorData3D.get(i))));
+            result.data3D().emplace_back(createNode<E57Data3D>(
+                e57::StructureNode(vectorData3D.get(i)),
+                &E57ReaderImpl::parseData3D));
         }
     }
 
@@ -143,109 +203,338 @@ E57RootPtr E57ReaderImpl::parseRoot(const e57::StructureNode& node)
         auto vectorImages2D = e57::VectorNode(node.get("images2D"));
         for (int64_t i = 0; i < vectorImages2D.childCount(); ++i)
         {
-            result->images2D().emplace_back(
-                parseImage2D(e57::StructureNode(vectorImages2D.get(i))));
+            result.images2D().emplace_back(createNode<E57Image2D>(
+                e57::StructureNode(vectorImages2D.get(i)),
+                &E57ReaderImpl::parseImage2D));
         }
     }
+}
+
+E57RootPtr E57ReaderImpl::parseRoot(const e57::StructureNode& node)
+{
+    auto result = createNode<E57Root>(node, &E57ReaderImpl::parseStructure);
+
+    if (!m_options.lazy)
+    {
+        parseRootChildren(*result, node);
+        return result;
+    }
 
+    std::weak_ptr<bool> alive = m_alive;
+    result->setChildrenLoader(
+        [this, alive, node](E57Root& root)
+        {
+            throwIfExpired(alive);
+            parseRootChildren(root, node);
+        });
     return result;
 }
 
-E57ReaderImpl::E57ReaderImpl(const std::string& filename)
-    : m_imageFile(filename, "r")
+E57ReaderImpl::E57ReaderImpl(const std::string& filename,
+                             const E57ReaderOptions& options)
+    : m_filename(filename), m_options(options)
 {
+    if (m_options.useIndex)
+    {
+        if (!loadIndex())
+        {
+            // the index is written from the complete tree
+            m_options.lazy = false;
+            parseNodeTree();
+            saveIndex();
+        }
+        loadColumnStats();
+        return;
+    }
+
     parseNodeTree();
 }
 
+E57ReaderImpl::~E57ReaderImpl()
+{
+    m_alive.reset();
+    if (m_imageFile)
+    {
+        closeImageFile(*m_imageFile);
+    }
+}
+
 const E57RootPtr& E57ReaderImpl::root() const
 {
     return m_root;
 }
 
+e57::ImageFile& E57ReaderImpl::imageFile() const
+{
+    if (!m_imageFile)
+    {
+        m_imageFile = openImageFile(m_filename);
+
+        if (m_indexGuid)
+        {
+            auto root = m_imageFile->root();
+            std::string guid;
+            if (isDefined(root, "guid"))
+            {
+                guid = e57::StringNode(root.get("guid")).value();
+            }
+            if (guid != *m_indexGuid)
+            {
+                closeImageFile(*m_imageFile);
+                m_imageFile.reset();
+                throw std::runtime_error(
+                    "File does not match its index. Delete " +
+                    E57Index::indexPath(m_filename) + ".");
+            }
+        }
+    }
+    return *m_imageFile;
+}
+
 void E57ReaderImpl::parseNodeTree()
 {
-    e57::StructureNode root = m_imageFile.root();
+    e57::StructureNode root = imageFile().root();
     m_root = parseRoot(root);
-    m_root->setName(
-        std::filesystem::path(m_imageFile.fileName()).stem().string());
+    m_root->setName(std::filesystem::path(m_filename).stem().string());
 }
 
-uint32_t E57ReaderImpl::registerBlob(e57::BlobNode& blob)
+bool E57ReaderImpl::loadIndex()
 {
-    m_blobs.push_back(blob);
-    return m_blobs.size() - 1;
+    auto index = E57Index::load(m_filename);
+    if (!index)
+    {
+        return false;
+    }
+
+    m_indexGuid = std::move(index->guid);
+    m_root = std::move(index->root);
+    m_blobs = std::move(index->blobs);
+    m_data = std::move(index->data);
+    m_root->setName(std::filesystem::path(m_filename).stem().string());
+    return true;
 }
 
-uint32_t E57ReaderImpl::registerData(e57::CompressedVectorNode& data)
+void E57ReaderImpl::saveIndex() const
 {
-    m_data.push_back(data);
-    return m_data.size() - 1;
+    E57Index index;
+    index.guid = m_root->getString("guid");
+    index.root = m_root;
+    index.blobs = m_blobs;
+    index.data = m_data;
+
+    // the index is a cache, the reader works without it
+    index.save(m_filename);
 }
 
-std::vector<uint8_t> E57ReaderImpl::blobData(uint32_t blobId) const
+void E57ReaderImpl::loadColumnStats()
 {
-    if (m_blobs.size() <= blobId)
-        throw std::runtime_error("Cannot retrieve blob data. Invalid blob id.");
-
-    auto blob = m_blobs.at(blobId);
-    std::vector<uint8_t> buffer(blob.byteCount());
-    blob.read(buffer.data(), 0, blob.byteCount());
-    return buffer;
+    auto stats = E57Index::loadColumnStats(m_filename);
+    std::erase_if(stats, [this](const auto& data)
+                  { return data.first >= m_data.size(); });
+    std::lock_guard<std::mutex> lock(m_columnStatsMutex);
+    m_columnStats = std::move(stats);
 }
 
-std::vector<E57DataInfo> E57ReaderImpl::dataInfo(uint32_t dataId) const
+uint32_t E57ReaderImpl::registerBlob(const e57::BlobNode& blob)
 {
-    if (m_data.size() <= dataId)
-        throw std::runtime_error("Cannot retrieve data. Invalid data id.");
+    m_blobs.push_back(
+        {blob.pathName(), static_cast<uint64_t>(blob.byteCount())});
+    return m_blobs.size() - 1;
+}
 
-    auto data = m_data.at(dataId);
+uint32_t E57ReaderImpl::registerData(const e57::CompressedVectorNode& data)
+{
     auto prototype = e57::StructureNode(data.prototype());
 
-    std::vector<E57DataInfo> result;
-
-    for (uint64_t i = 0; i < prototype.childCount(); ++i)
+    std::vector<E57DataInfo> dataInfo;
+    for (int64_t i = 0; i < prototype.childCount(); ++i)
     {
         auto child = prototype.get(i);
 
-        E57DataInfo dataInfo;
-        dataInfo.identifier = child.elementName();
+        E57DataInfo info;
+        info.identifier = child.elementName();
 
         switch (child.type())
         {
         case e57::TypeInteger:
         {
             auto c = e57::IntegerNode(child);
-            dataInfo.dataType = E57DataType::INTEGER;
-            dataInfo.minValue = c.minimum();
-            dataInfo.maxValue = c.maximum();
+            info.dataType = E57DataType::INTEGER;
+            info.minValue = c.minimum();
+            info.maxValue = c.maximum();
             break;
         }
         case e57::TypeScaledInteger:
         {
             auto c = e57::ScaledIntegerNode(child);
-            dataInfo.dataType = E57DataType::FLOAT;
-            dataInfo.minValue = c.scaledMinimum();
-            dataInfo.maxValue = c.scaledMaximum();
+            info.dataType = E57DataType::FLOAT;
+            info.minValue = c.scaledMinimum();
+            info.maxValue = c.scaledMaximum();
             break;
         }
         case e57::TypeFloat:
         {
             auto c = e57::FloatNode(child);
-            dataInfo.dataType = E57DataType::FLOAT;
-            dataInfo.minValue = c.minimum();
-            dataInfo.maxValue = c.maximum();
+            info.dataType = E57DataType::FLOAT;
+            info.minValue = c.minimum();
+            info.maxValue = c.maximum();
             break;
         }
         default:
             continue;
         }
 
-        result.push_back(dataInfo);
+        dataInfo.push_back(info);
+    }
+
+    m_data.push_back({data.pathName(), static_cast<uint64_t>(data.childCount()),
+                      std::move(dataInfo)});
+    return m_data.size() - 1;
+}
+
+std::vector<uint8_t> E57ReaderImpl::blobData(uint32_t blobId) const
+{
+    std::vector<uint8_t> buffer(blobSize(blobId));
+    readBlob(blobId, 0, buffer);
+    return buffer;
+}
+
+uint64_t E57ReaderImpl::blobSize(uint32_t blobId) const
+{
+    if (m_blobs.size() <= blobId)
+        throw std::runtime_error("Cannot retrieve blob data. Invalid blob id.");
+
+    return m_blobs.at(blobId).size;
+}
+
+uint64_t E57ReaderImpl::readBlob(uint32_t blobId, uint64_t offset,
+                                 std::span<uint8_t> buffer) const
+{
+    uint64_t size = blobSize(blobId);
+    if (offset >= size)
+        return 0;
+
+    uint64_t count = std::min<uint64_t>(buffer.size(), size - offset);
+    auto blob = e57::BlobNode(imageFile().root().get(m_blobs.at(blobId).path));
+    blob.read(buffer.data(), static_cast<int64_t>(offset), count);
+    return count;
+}
+
+std::vector<E57DataInfo> E57ReaderImpl::dataInfo(uint32_t dataId) const
+{
+    if (m_data.size() <= dataId)
+        throw std::runtime_error("Cannot retrieve data. Invalid data id.");
+
+    return m_data.at(dataId).dataInfo;
+}
+
+uint64_t E57ReaderImpl::recordCount(uint32_t dataId) const
+{
+    if (m_data.size() <= dataId)
+        throw std::runtime_error("Cannot retrieve data. Invalid data id.");
+
+    return m_data.at(dataId).recordCount;
+}
+
+std::vector<E57ColumnStats>
+E57ReaderImpl::columnStats(uint32_t dataId,
+                           const std::vector<std::string>& columns)
+{
+    static const uint32_t BATCH_SIZE = 65536;
+
+    auto reader = dataReader(dataId);
+
+    // decode all columns which are not cached yet in one pass
+    std::vector<std::string> missing;
+    for (const auto& column : columns)
+    {
+        if (reader->hasField(column) && !cachedColumnStats(dataId, column) &&
+            std::find(missing.begin(), missing.end(), column) == missing.end())
+        {
+            missing.push_back(column);
+        }
+    }
+
+    if (!missing.empty())
+    {
+        std::vector<std::vector<double>> buffers(
+            missing.size(), std::vector<double>(BATCH_SIZE));
+        std::vector<E57ColumnStatsAccumulator> accumulators(missing.size());
+        for (size_t i = 0; i < missing.size(); ++i)
+        {
+            reader->bindBuffer(missing[i], buffers[i].data(), BATCH_SIZE);
+        }
+
+        uint64_t count;
+        while ((count = reader->read()) > 0)
+        {
+            for (size_t i = 0; i < missing.size(); ++i)
+            {
+                accumulators[i].add(
+                    std::span<const double>(buffers[i].data(), count));
+            }
+        }
+
+        E57Index::ColumnStats computed;
+        for (size_t i = 0; i < missing.size(); ++i)
+        {
+            computed[dataId][missing[i]] = accumulators[i].result(missing[i]);
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_columnStatsMutex);
+            for (const auto& [identifier, stats] : computed[dataId])
+            {
+                m_columnStats[dataId][identifier] = stats;
+            }
+        }
+        if (m_options.useIndex)
+        {
+            E57Index::saveColumnStats(m_filename, computed);
+        }
     }
 
+    std::vector<E57ColumnStats> result;
+    for (const auto& column : columns)
+    {
+        if (auto stats = cachedColumnStats(dataId, column))
+        {
+            result.push_back(std::move(*stats));
+        }
+    }
     return result;
 }
 
+std::optional<E57ColumnStats>
+E57ReaderImpl::cachedColumnStats(uint32_t dataId,
+                                 const std::string& column) const
+{
+    std::lock_guard<std::mutex> lock(m_columnStatsMutex);
+    auto data = m_columnStats.find(dataId);
+    if (data == m_columnStats.end())
+        return std::nullopt;
+    auto stats = data->second.find(column);
+    if (stats == data->second.end())
+        return std::nullopt;
+    return stats->second;
+}
+
+void E57ReaderImpl::setColumnStats(uint32_t dataId,
+                                   const E57ColumnStats& stats)
+{
+    if (m_data.size() <= dataId)
+        throw std::runtime_error("Cannot retrieve data. Invalid data id.");
+
+    {
+        std::lock_guard<std::mutex> lock(m_columnStatsMutex);
+        m_columnStats[dataId][stats.identifier] = stats;
+    }
+    if (m_options.useIndex)
+    {
+        E57Index::saveColumnStats(m_filename,
+                                  {{dataId, {{stats.identifier, stats}}}});
+    }
+}
+
 std::string readFileSignature(std::ifstream& ifs)
 {
     char data[8];
@@ -261,9 +550,91 @@ std::string readVersion(std::ifstream& ifs)
     return std::to_string(versionMajor) + "." + std::to_string(versionMinor);
 }
 
-std::string E57ReaderImpl::dumpXML(int indent) const
+void E57ReaderImpl::decodeScans(const std::vector<uint32_t>& dataIds,
+                                uint32_t threads,
+                                const DecodeCallback& callback) const
 {
-    std::ifstream ifs(m_imageFile.fileName(), std::ios::binary);
+    std::vector<std::string> paths;
+    for (uint32_t dataId : dataIds)
+    {
+        if (m_data.size() <= dataId)
+            throw std::runtime_error("Cannot retrieve data. Invalid data id.");
+        paths.push_back(m_data.at(dataId).path);
+    }
+
+    if (dataIds.empty())
+    {
+        return;
+    }
+
+    if (threads == 0)
+    {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    threads = std::min<uint32_t>(threads, dataIds.size());
+
+    std::atomic<size_t> next{0};
+    std::atomic<bool> failed{false};
+    std::exception_ptr exception;
+    std::mutex exceptionMutex;
+
+    auto worker = [&]()
+    {
+        try
+        {
+            // every worker decodes from its own image file, as the handles of
+            // one image file must not be shared between threads
+            e57::ImageFile imageFile = openImageFile(m_filename);
+            try
+            {
+                size_t index;
+                while (!failed && (index = next++) < dataIds.size())
+                {
+                    auto data = e57::CompressedVectorNode(
+                        imageFile.root().get(paths[index]));
+                    callback(dataIds[index],
+                             std::make_shared<E57DataReaderImpl>(
+                                 e57::StructureNode(data.parent()), data));
+                }
+            }
+            catch (...)
+            {
+                closeImageFile(imageFile);
+                throw;
+            }
+            closeImageFile(imageFile);
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(exceptionMutex);
+            if (!exception)
+            {
+                exception = std::current_exception();
+            }
+            failed = true;
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (uint32_t i = 1; i < threads; ++i)
+    {
+        workers.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : workers)
+    {
+        thread.join();
+    }
+
+    if (exception)
+    {
+        std::rethrow_exception(exception);
+    }
+}
+
+std::string E57ReaderImpl::dumpXML(int indent, bool verifyChecksums) const
+{
+    std::ifstream ifs(m_filename, std::ios::binary);
     std::string fileSignature = readFileSignature(ifs);
     std::string version = readVersion(ifs);
 
@@ -275,20 +646,21 @@ std::string E57ReaderImpl::dumpXML(int indent) const
     ifs.close();
 
     const int8_t CRC_LEN = 4;
-    std::vector<char> xml(xmlLength, 0);
-    PagedBinaryFileReader bfr(m_imageFile.fileName(), pageSize,
-                              pageSize - CRC_LEN);
+    std::string xml(xmlLength, '\0');
+    PagedBinaryFileReader bfr(m_filename, pageSize,
+                              pageSize - CRC_LEN, verifyChecksums);
     bfr.seek(xmlOffset);
-    bfr.readBytes(xml, xml.size());
+    xml.resize(bfr.readBytes(xml.data(), xml.size()));
 
-    return std::string(xml.begin(), xml.end());
+    return xml;
 }
 
 std::shared_ptr<E57DataReaderImpl> E57ReaderImpl::dataReader(uint32_t dataId)
 {
     if (m_data.size() <= dataId)
         throw std::runtime_error("Cannot retrieve data. Invalid data id.");
-    auto data = m_data.at(dataId);
+    auto data = e57::CompressedVectorNode(
+        imageFile().root().get(m_data.at(dataId).path));
     return std::make_shared<E57DataReaderImpl>(
         e57::StructureNode(data.parent()), data);
 }
@@ -336,133 +708,13 @@ E57Pose E57ReaderImpl::parsePose(const e57::StructureNode& node)
 E57DataReaderImpl::E57DataReaderImpl(e57::StructureNode parent,
                                      e57::CompressedVectorNode node)
     : m_parent{std::move(parent)}, m_node{std::move(node)},
-      m_reader{std::nullopt}
-{
-}
-
-void E57DataReaderImpl::bindBuffer(const std::string& identifier, float* buffer,
-                                   uint32_t bufferSize, uint32_t stride)
-{
-    auto prototype = e57::StructureNode(m_node.prototype());
-
-    if (isDefined(prototype, identifier))
-    {
-        m_sourceDestBuffers.emplace_back(m_node.destImageFile(), identifier,
-                                         buffer, bufferSize, true, true,
-                                         stride);
-    }
-}
-
-void E57DataReaderImpl::bindBuffer(const std::string& identifier,
-                                   double* buffer, uint32_t bufferSize,
-                                   uint32_t stride)
-{
-    auto prototype = e57::StructureNode(m_node.prototype());
-
-    if (isDefined(prototype, identifier))
-    {
-        m_sourceDestBuffers.emplace_back(m_node.destImageFile(), identifier,
-                                         buffer, bufferSize, true, true,
-                                         stride);
-    }
-}
-
-void E57DataReaderImpl::bindBuffer(const std::string& identifier,
-                                   int8_t* buffer, uint32_t bufferSize,
-                                   uint32_t stride)
-{
-    auto prototype = e57::StructureNode(m_node.prototype());
-
-    if (isDefined(prototype, identifier))
-    {
-        m_sourceDestBuffers.emplace_back(m_node.destImageFile(), identifier,
-                                         buffer, bufferSize, true, true,
-                                         stride);
-    }
-}
-
-void E57DataReaderImpl::bindBuffer(const std::string& identifier,
-                                   int16_t* buffer, uint32_t bufferSize,
-                                   uint32_t stride)
-{
-    auto prototype = e57::StructureNode(m_node.prototype());
-
-    if (isDefined(prototype, identifier))
-    {
-        m_sourceDestBuffers.emplace_back(m_node.destImageFile(), identifier,
-                                         buffer, bufferSize, true, true,
-                                         stride);
-    }
-}
-
-void E57DataReaderImpl::bindBuffer(const std::string& identifier,
-                                   int32_t* buffer, uint32_t bufferSize,
-                                   uint32_t stride)
-{
-    auto prototype = e57::StructureNode(m_node.prototype());
-
-    if (isDefined(prototype, identifier))
-    {
-        m_sourceDestBuffers.emplace_back(m_node.destImageFile(), identifier,
-                                         buffer, bufferSize, true, true,
-                                         stride);
-    }
-}
-
-void E57DataReaderImpl::bindBuffer(const std::string& identifier,
-                                   int64_t* buffer, uint32_t bufferSize,
-                                   uint32_t stride)
+      m_prototype{m_node.prototype()}, m_reader{std::nullopt}
 {
-    auto prototype = e57::StructureNode(m_node.prototype());
-
-    if (isDefined(prototype, identifier))
-    {
-        m_sourceDestBuffers.emplace_back(m_node.destImageFile(), identifier,
-                                         buffer, bufferSize, true, true,
-                                         stride);
-    }
 }
 
-void E57DataReaderImpl::bindBuffer(const std::string& identifier,
-                                   uint8_t* buffer, uint32_t bufferSize,
-                                   uint32_t stride)
+bool E57DataReaderImpl::hasField(const std::string& identifier) const
 {
-    auto prototype = e57::StructureNode(m_node.prototype());
-
-    if (isDefined(prototype, identifier))
-    {
-        m_sourceDestBuffers.emplace_back(m_node.destImageFile(), identifier,
-                                         buffer, bufferSize, true, true,
-                                         stride);
-    }
-}
-
-void E57DataReaderImpl::bindBuffer(const std::string& identifier,
-                                   uint16_t* buffer, uint32_t bufferSize,
-                                   uint32_t stride)
-{
-    auto prototype = e57::StructureNode(m_node.prototype());
-
-    if (isDefined(prototype, identifier))
-    {
-        m_sourceDestBuffers.emplace_back(m_node.destImageFile(), identifier,
-                                         buffer, bufferSize, true, true,
-                                         stride);
-    }
-}
-
-void E57DataReaderImpl::bindBuffer(const std::string& identifier,
-                                   uint32_t* buffer, uint32_t bufferSize,
-                                   uint32_t stride)
-{
-    auto prototype = e57::StructureNode(m_node.prototype());
-
-    if (isDefined(prototype, identifier))
-    {
-        m_sourceDestBuffers.emplace_back(m_node.destImageFile(), identifier,
-                                         buffer, bufferSize, true, true,
-                                         stride);
-    }
+    return isDefined(m_prototype, identifier);
 }
 
 uint64_t E57DataReaderImpl::read()
@@ -480,7 +732,19 @@ uint64_t E57DataReaderImpl::read()
         throw std::runtime_error("Node is not attached.");
     }
 
-    return m_reader->read(m_sourceDestBuffers);
+    uint64_t count = m_reader->read(m_sourceDestBuffers);
+    m_position += count;
+    return count;
+}
+
+uint64_t E57DataReaderImpl::position() const
+{
+    return m_position;
+}
+
+uint64_t E57DataReaderImpl::recordCount() const
+{
+    return m_node.childCount();
 }
 
 E57DataReaderImpl::~E57DataReaderImpl()
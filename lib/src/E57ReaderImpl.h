@@ -1,8 +1,12 @@
 #ifndef E57INSPECTOR_E57READERIMPL_H
 #define E57INSPECTOR_E57READERIMPL_H
 
+#include <functional>
+#include <map>
+#include <mutex>
 #include <optional>
 #include <set>
+#include <span>
 #include <string>
 
 #include <E57Format.h>
@@ -10,6 +14,8 @@
 #include <e57inspector/E57Node.h>
 #include <e57inspector/E57Reader.h>
 
+#include "E57Index.h"
+
 class E57DataReaderImpl
 {
 public:
@@ -17,62 +23,108 @@ public:
                       e57::CompressedVectorNode node);
     ~E57DataReaderImpl();
 
-    void bindBuffer(const std::string& identifier, float* buffer,
-                    uint32_t bufferSize, uint32_t stride = sizeof(float));
-    void bindBuffer(const std::string& identifier, double* buffer,
-                    uint32_t bufferSize, uint32_t stride = sizeof(double));
-
-    void bindBuffer(const std::string& identifier, int8_t* buffer,
-                    uint32_t bufferSize, uint32_t stride = sizeof(int8_t));
-    void bindBuffer(const std::string& identifier, int16_t* buffer,
-                    uint32_t bufferSize, uint32_t stride = sizeof(int16_t));
-    void bindBuffer(const std::string& identifier, int32_t* buffer,
-                    uint32_t bufferSize, uint32_t stride = sizeof(int32_t));
-    void bindBuffer(const std::string& identifier, int64_t* buffer,
-                    uint32_t bufferSize, uint32_t stride = sizeof(int64_t));
-
-    void bindBuffer(const std::string& identifier, uint8_t* buffer,
-                    uint32_t bufferSize, uint32_t stride = sizeof(uint8_t));
-    void bindBuffer(const std::string& identifier, uint16_t* buffer,
-                    uint32_t bufferSize, uint32_t stride = sizeof(uint16_t));
-    void bindBuffer(const std::string& identifier, uint32_t* buffer,
-                    uint32_t bufferSize, uint32_t stride = sizeof(uint32_t));
+    template <typename T>
+    void bindBuffer(const std::string& identifier, T* buffer,
+                    uint32_t bufferSize, uint32_t stride = sizeof(T))
+    {
+        if (hasField(identifier))
+        {
+            m_sourceDestBuffers.emplace_back(m_node.destImageFile(),
+                                             identifier, buffer, bufferSize,
+                                             true, true, stride);
+        }
+    }
+
+    [[nodiscard]] bool hasField(const std::string& identifier) const;
+
     uint64_t read();
 
+    [[nodiscard]] uint64_t position() const;
+    [[nodiscard]] uint64_t recordCount() const;
+
 private:
     e57::StructureNode m_parent;
     e57::CompressedVectorNode m_node;
+    e57::StructureNode m_prototype;
     std::optional<e57::CompressedVectorReader> m_reader;
     std::vector<e57::SourceDestBuffer> m_sourceDestBuffers;
+
+    uint64_t m_position{0};
 };
 
 class E57ReaderImpl
 {
 public:
-    explicit E57ReaderImpl(const std::string& filename);
+    using DecodeCallback = std::function<void(
+        uint32_t dataId, std::shared_ptr<E57DataReaderImpl> dataReader)>;
+
+    E57ReaderImpl(const std::string& filename,
+                  const E57ReaderOptions& options);
+    ~E57ReaderImpl();
+
     [[nodiscard]] const E57RootPtr& root() const;
     [[nodiscard]] std::vector<uint8_t> blobData(uint32_t blobId) const;
+    [[nodiscard]] uint64_t blobSize(uint32_t blobId) const;
+    uint64_t readBlob(uint32_t blobId, uint64_t offset,
+                      std::span<uint8_t> buffer) const;
     [[nodiscard]] std::vector<E57DataInfo> dataInfo(uint32_t dataId) const;
-    [[nodiscard]] std::string dumpXML(int indent = 4) const;
+    [[nodiscard]] uint64_t recordCount(uint32_t dataId) const;
+    [[nodiscard]] std::string dumpXML(int indent = 4,
+                                      bool verifyChecksums = false) const;
     std::shared_ptr<E57DataReaderImpl> dataReader(uint32_t dataId);
+    std::vector<E57ColumnStats>
+    columnStats(uint32_t dataId, const std::vector<std::string>& columns);
+    [[nodiscard]] std::optional<E57ColumnStats>
+    cachedColumnStats(uint32_t dataId, const std::string& column) const;
+    void setColumnStats(uint32_t dataId, const E57ColumnStats& stats);
+    void decodeScans(const std::vector<uint32_t>& dataIds, uint32_t threads,
+                     const DecodeCallback& callback) const;
 
 private:
-    e57::ImageFile m_imageFile;
+    std::string m_filename;
+    E57ReaderOptions m_options;
+    // opened on first use if the reader was created from an index
+    mutable std::optional<e57::ImageFile> m_imageFile;
+    // GUID stored in the index, checked when the image file is opened
+    std::optional<std::string> m_indexGuid;
     E57RootPtr m_root;
-    std::vector<e57::BlobNode> m_blobs;
-    std::vector<e57::CompressedVectorNode> m_data;
+    std::vector<E57Index::Blob> m_blobs;
+    std::vector<E57Index::Data> m_data;
+
+    // column statistics per data id and field name
+    E57Index::ColumnStats m_columnStats;
+    mutable std::mutex m_columnStatsMutex;
+
+    // expires with the reader, lazy node loaders check it before running
+    std::shared_ptr<bool> m_alive{std::make_shared<bool>(true)};
+
+    e57::ImageFile& imageFile() const;
 
     void parseNodeTree();
+    bool loadIndex();
+    void saveIndex() const;
+    void loadColumnStats();
+
+    /**
+     * Creates a node named after the given structure and fills it with the
+     * parse function, either right away or on first access in lazy mode.
+     */
+    template <typename T, typename U>
+    std::shared_ptr<T>
+    createNode(const e57::StructureNode& node,
+               void (E57ReaderImpl::*parse)(U&, const e57::StructureNode&));
 
-    void parseFields(E57NodePtr result, const e57::StructureNode& node,
+    void parseFields(E57Node& result, const e57::StructureNode& node,
                      const std::set<std::string>& ignoreFields = {});
+    void parseStructure(E57Node& result, const e57::StructureNode& node);
     E57RootPtr parseRoot(const e57::StructureNode& node);
-    E57Image2DPtr parseImage2D(const e57::StructureNode& node);
-    E57Data3DPtr parseData3D(const e57::StructureNode& node);
+    void parseRootChildren(E57Root& result, const e57::StructureNode& node);
+    void parseImage2D(E57Image2D& result, const e57::StructureNode& node);
+    void parseData3D(E57Data3D& result, const e57::StructureNode& node);
     E57Pose parsePose(const e57::StructureNode& node);
 
-    uint32_t registerBlob(e57::BlobNode& blob);
-    uint32_t registerData(e57::CompressedVectorNode& data);
+    uint32_t registerBlob(const e57::BlobNode& blob);
+    uint32_t registerData(const e57::CompressedVectorNode& data);
 };
 
 #endif // E57INSPECTOR_E57READERIMPL_H
@@ -0,0 +1,225 @@
+#include <e57inspector/E57Spherical.h>
+
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+
+// the FORCE definitions select a narrower path than the compiler supports,
+// so the tests cover every path
+#if defined(E57INSPECTOR_SPHERICAL_FORCE_SCALAR)
+#elif defined(__AVX2__) && (defined(__FMA__) || defined(_MSC_VER)) &&         \
+    !defined(E57INSPECTOR_SPHERICAL_FORCE_SSE2)
+#include <immintrin.h>
+#define E57INSPECTOR_SPHERICAL_AVX2
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define E57INSPECTOR_SPHERICAL_SSE2
+#endif
+
+namespace
+{
+void convertScalar(const float* range, const float* elevation,
+                   const float* azimuth, std::array<float, 3>* xyz,
+                   size_t size)
+{
+    for (size_t i = 0; i < size; ++i)
+    {
+        const float projected = range[i] * std::cos(elevation[i]);
+        xyz[i] = {projected * std::cos(azimuth[i]),
+                  projected * std::sin(azimuth[i]),
+                  range[i] * std::sin(elevation[i])};
+    }
+}
+
+#if defined(E57INSPECTOR_SPHERICAL_AVX2) || defined(E57INSPECTOR_SPHERICAL_SSE2)
+// Cephes sinf/cosf: the argument is reduced to [-pi/4, pi/4] with an
+// extended precision pi/4 and the octant selects polynomial and sign
+constexpr float FOUR_OVER_PI = 1.27323954473516f;
+constexpr float DP1 = -0.78515625f;
+constexpr float DP2 = -2.4187564849853515625e-4f;
+constexpr float DP3 = -3.77489497744594108e-8f;
+constexpr float SIN_P0 = -1.9515295891e-4f;
+constexpr float SIN_P1 = 8.3321608736e-3f;
+constexpr float SIN_P2 = -1.6666654611e-1f;
+constexpr float COS_P0 = 2.443315711809948e-5f;
+constexpr float COS_P1 = -1.388731625493765e-3f;
+constexpr float COS_P2 = 4.166664568298827e-2f;
+#endif
+
+#ifdef E57INSPECTOR_SPHERICAL_AVX2
+constexpr size_t WIDTH = 8;
+
+void sinCos(__m256 x, __m256& sin, __m256& cos)
+{
+    const __m256 signMask = _mm256_castsi256_ps(_mm256_set1_epi32(INT32_MIN));
+    __m256 signSin = _mm256_and_ps(x, signMask);
+    x = _mm256_andnot_ps(signMask, x);
+
+    __m256i octant =
+        _mm256_cvttps_epi32(_mm256_mul_ps(x, _mm256_set1_ps(FOUR_OVER_PI)));
+    octant = _mm256_and_si256(_mm256_add_epi32(octant, _mm256_set1_epi32(1)),
+                              _mm256_set1_epi32(~1));
+    const __m256 y = _mm256_cvtepi32_ps(octant);
+
+    const __m256 swapSign = _mm256_castsi256_ps(_mm256_slli_epi32(
+        _mm256_and_si256(octant, _mm256_set1_epi32(4)), 29));
+    const __m256 polyMask = _mm256_castsi256_ps(
+        _mm256_cmpeq_epi32(_mm256_and_si256(octant, _mm256_set1_epi32(2)),
+                           _mm256_setzero_si256()));
+    const __m256 signCos = _mm256_castsi256_ps(_mm256_slli_epi32(
+        _mm256_andnot_si256(_mm256_sub_epi32(octant, _mm256_set1_epi32(2)),
+                            _mm256_set1_epi32(4)),
+        29));
+    signSin = _mm256_xor_ps(signSin, swapSign);
+
+    x = _mm256_fmadd_ps(y, _mm256_set1_ps(DP1), x);
+    x = _mm256_fmadd_ps(y, _mm256_set1_ps(DP2), x);
+    x = _mm256_fmadd_ps(y, _mm256_set1_ps(DP3), x);
+    const __m256 z = _mm256_mul_ps(x, x);
+
+    __m256 polyCos = _mm256_fmadd_ps(_mm256_set1_ps(COS_P0), z,
+                                     _mm256_set1_ps(COS_P1));
+    polyCos = _mm256_fmadd_ps(polyCos, z, _mm256_set1_ps(COS_P2));
+    polyCos = _mm256_mul_ps(_mm256_mul_ps(polyCos, z), z);
+    polyCos = _mm256_fnmadd_ps(_mm256_set1_ps(0.5f), z, polyCos);
+    polyCos = _mm256_add_ps(polyCos, _mm256_set1_ps(1.0f));
+
+    __m256 polySin = _mm256_fmadd_ps(_mm256_set1_ps(SIN_P0), z,
+                                     _mm256_set1_ps(SIN_P1));
+    polySin = _mm256_fmadd_ps(polySin, z, _mm256_set1_ps(SIN_P2));
+    polySin = _mm256_fmadd_ps(_mm256_mul_ps(polySin, z), x, x);
+
+    sin = _mm256_xor_ps(_mm256_blendv_ps(polyCos, polySin, polyMask), signSin);
+    cos = _mm256_xor_ps(_mm256_blendv_ps(polySin, polyCos, polyMask), signCos);
+}
+
+void convertBlock(const float* range, const float* elevation,
+                  const float* azimuth, std::array<float, 3>* xyz)
+{
+    __m256 sinElevation, cosElevation, sinAzimuth, cosAzimuth;
+    sinCos(_mm256_loadu_ps(elevation), sinElevation, cosElevation);
+    sinCos(_mm256_loadu_ps(azimuth), sinAzimuth, cosAzimuth);
+    const __m256 r = _mm256_loadu_ps(range);
+    const __m256 projected = _mm256_mul_ps(r, cosElevation);
+
+    alignas(32) float x[WIDTH];
+    alignas(32) float y[WIDTH];
+    alignas(32) float z[WIDTH];
+    _mm256_store_ps(x, _mm256_mul_ps(projected, cosAzimuth));
+    _mm256_store_ps(y, _mm256_mul_ps(projected, sinAzimuth));
+    _mm256_store_ps(z, _mm256_mul_ps(r, sinElevation));
+    for (size_t i = 0; i < WIDTH; ++i)
+    {
+        xyz[i] = {x[i], y[i], z[i]};
+    }
+}
+#endif
+
+#ifdef E57INSPECTOR_SPHERICAL_SSE2
+constexpr size_t WIDTH = 4;
+
+__m128 select(__m128 mask, __m128 a, __m128 b)
+{
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+void sinCos(__m128 x, __m128& sin, __m128& cos)
+{
+    const __m128 signMask = _mm_castsi128_ps(_mm_set1_epi32(INT32_MIN));
+    __m128 signSin = _mm_and_ps(x, signMask);
+    x = _mm_andnot_ps(signMask, x);
+
+    __m128i octant =
+        _mm_cvttps_epi32(_mm_mul_ps(x, _mm_set1_ps(FOUR_OVER_PI)));
+    octant = _mm_and_si128(_mm_add_epi32(octant, _mm_set1_epi32(1)),
+                           _mm_set1_epi32(~1));
+    const __m128 y = _mm_cvtepi32_ps(octant);
+
+    const __m128 swapSign = _mm_castsi128_ps(
+        _mm_slli_epi32(_mm_and_si128(octant, _mm_set1_epi32(4)), 29));
+    const __m128 polyMask = _mm_castsi128_ps(_mm_cmpeq_epi32(
+        _mm_and_si128(octant, _mm_set1_epi32(2)), _mm_setzero_si128()));
+    const __m128 signCos = _mm_castsi128_ps(_mm_slli_epi32(
+        _mm_andnot_si128(_mm_sub_epi32(octant, _mm_set1_epi32(2)),
+                         _mm_set1_epi32(4)),
+        29));
+    signSin = _mm_xor_ps(signSin, swapSign);
+
+    x = _mm_add_ps(x, _mm_mul_ps(y, _mm_set1_ps(DP1)));
+    x = _mm_add_ps(x, _mm_mul_ps(y, _mm_set1_ps(DP2)));
+    x = _mm_add_ps(x, _mm_mul_ps(y, _mm_set1_ps(DP3)));
+    const __m128 z = _mm_mul_ps(x, x);
+
+    __m128 polyCos =
+        _mm_add_ps(_mm_mul_ps(_mm_set1_ps(COS_P0), z), _mm_set1_ps(COS_P1));
+    polyCos = _mm_add_ps(_mm_mul_ps(polyCos, z), _mm_set1_ps(COS_P2));
+    polyCos = _mm_mul_ps(_mm_mul_ps(polyCos, z), z);
+    polyCos = _mm_sub_ps(polyCos, _mm_mul_ps(_mm_set1_ps(0.5f), z));
+    polyCos = _mm_add_ps(polyCos, _mm_set1_ps(1.0f));
+
+    __m128 polySin =
+        _mm_add_ps(_mm_mul_ps(_mm_set1_ps(SIN_P0), z), _mm_set1_ps(SIN_P1));
+    polySin = _mm_add_ps(_mm_mul_ps(polySin, z), _mm_set1_ps(SIN_P2));
+    polySin = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(polySin, z), x), x);
+
+    sin = _mm_xor_ps(select(polyMask, polySin, polyCos), signSin);
+    cos = _mm_xor_ps(select(polyMask, polyCos, polySin), signCos);
+}
+
+void convertBlock(const float* range, const float* elevation,
+                  const float* azimuth, std::array<float, 3>* xyz)
+{
+    __m128 sinElevation, cosElevation, sinAzimuth, cosAzimuth;
+    sinCos(_mm_loadu_ps(elevation), sinElevation, cosElevation);
+    sinCos(_mm_loadu_ps(azimuth), sinAzimuth, cosAzimuth);
+    const __m128 r = _mm_loadu_ps(range);
+    const __m128 projected = _mm_mul_ps(r, cosElevation);
+
+    alignas(16) float x[WIDTH];
+    alignas(16) float y[WIDTH];
+    alignas(16) float z[WIDTH];
+    _mm_store_ps(x, _mm_mul_ps(projected, cosAzimuth));
+    _mm_store_ps(y, _mm_mul_ps(projected, sinAzimuth));
+    _mm_store_ps(z, _mm_mul_ps(r, sinElevation));
+    for (size_t i = 0; i < WIDTH; ++i)
+    {
+        xyz[i] = {x[i], y[i], z[i]};
+    }
+}
+#endif
+} // namespace
+
+void sphericalToCartesian(std::span<const float> range,
+                          std::span<const float> elevation,
+                          std::span<const float> azimuth,
+                          std::span<std::array<float, 3>> xyz)
+{
+    const size_t size = range.size();
+    if (elevation.size() != size || azimuth.size() != size ||
+        xyz.size() != size)
+    {
+        throw std::runtime_error("Spherical coordinate sizes do not match.");
+    }
+
+    size_t i = 0;
+#if defined(E57INSPECTOR_SPHERICAL_AVX2) || defined(E57INSPECTOR_SPHERICAL_SSE2)
+    for (; i + WIDTH <= size; i += WIDTH)
+    {
+        convertBlock(range.data() + i, elevation.data() + i,
+                     azimuth.data() + i, xyz.data() + i);
+    }
+#endif
+    convertScalar(range.data() + i, elevation.data() + i, azimuth.data() + i,
+                  xyz.data() + i, size - i);
+}
+
+const char* sphericalToCartesianInstructionSet()
+{
+#if defined(E57INSPECTOR_SPHERICAL_AVX2)
+    return "avx2";
+#elif defined(E57INSPECTOR_SPHERICAL_SSE2)
+    return "sse2";
+#else
+    return "scalar";
+#endif
+}
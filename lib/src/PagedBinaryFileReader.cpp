@@ -1,61 +1,115 @@
 #include "PagedBinaryFileReader.h"
 
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include "Crc32c.h"
+
 PagedBinaryFileReader::PagedBinaryFileReader(const std::string& filename,
                                              int64_t pageSize,
-                                             int64_t payloadSize)
+                                             int64_t payloadSize,
+                                             bool verifyChecksums)
     : m_file(filename, std::ios::binary), m_pageSize(pageSize),
-      m_payloadSize(payloadSize)
+      m_payloadSize(payloadSize), m_verifyChecksums(verifyChecksums)
 {
     if (!m_file)
     {
         throw std::runtime_error("Error opening file for reading.");
     }
-    fillBuffer();
+    if (m_pageSize <= 0 || m_payloadSize <= 0 || m_payloadSize > m_pageSize)
+    {
+        throw std::runtime_error("Invalid page size.");
+    }
+    m_buffer.resize(m_pageSize * PAGES_PER_BLOCK);
 }
 
-bool PagedBinaryFileReader::readBytes(std::vector<char>& bytes,
-                                      int64_t numBytes)
+int64_t PagedBinaryFileReader::readBytes(char* bytes, int64_t numBytes)
 {
-    bytes.clear();
-    while (numBytes > 0 && !m_endOfFile)
+    int64_t bytesRead = 0;
+    while (bytesRead < numBytes)
     {
-        int64_t bytesToRead = numBytes < m_payloadSize - m_currentPayloadIndex
-                                  ? numBytes
-                                  : m_payloadSize - m_currentPayloadIndex;
-        for (int i = 0; i < bytesToRead; ++i)
+        if (m_currentPayloadIndex == m_payloadSize)
         {
-            bytes.push_back(m_buffer[m_currentPayloadIndex]);
-            ++m_currentPayloadIndex;
+            ++m_currentPage;
+            m_currentPayloadIndex = 0;
         }
-        numBytes -= bytesToRead;
-        if (m_currentPayloadIndex == m_payloadSize)
+        if (m_currentPage >= m_bufferPageCount && !fillBuffer())
         {
-            fillBuffer();
+            break;
         }
+
+        int64_t bytesToRead = std::min(numBytes - bytesRead,
+                                       m_payloadSize - m_currentPayloadIndex);
+        std::memcpy(bytes + bytesRead,
+                    m_buffer.data() + m_currentPage * m_pageSize +
+                        m_currentPayloadIndex,
+                    bytesToRead);
+        m_currentPayloadIndex += bytesToRead;
+        bytesRead += bytesToRead;
     }
+    return bytesRead;
+}
+
+bool PagedBinaryFileReader::readBytes(std::vector<char>& bytes,
+                                      int64_t numBytes)
+{
+    bytes.resize(numBytes);
+    bytes.resize(readBytes(bytes.data(), numBytes));
     return !bytes.empty();
 }
 
-void PagedBinaryFileReader::seek(std::streampos pos)
+void PagedBinaryFileReader::seek(int64_t pos)
 {
-    std::streampos pageStart = pos / m_pageSize * m_pageSize;
-    std::streampos pageOffset = pos % m_pageSize;
+    m_bufferFirstPage = pos / m_pageSize;
+    m_bufferPageCount = 0;
+    m_currentPage = 0;
+    m_currentPayloadIndex = pos % m_pageSize;
 
-    m_file.seekg(pageStart, std::ios::beg);
-    fillBuffer();
+    if (m_currentPayloadIndex >= m_payloadSize)
+    {
+        throw std::runtime_error("Cannot seek into page checksum.");
+    }
+}
 
-    this->m_currentPayloadIndex += pageOffset;
+bool PagedBinaryFileReader::fillBuffer()
+{
+    // advance the block window to the page the reader currently points at
+    m_bufferFirstPage += m_currentPage;
+    m_currentPage = 0;
+
+    m_file.clear();
+    m_file.seekg(m_bufferFirstPage * m_pageSize, std::ios::beg);
+    m_file.read(m_buffer.data(), static_cast<std::streamsize>(m_buffer.size()));
+    m_bufferPageCount = m_file.gcount() / m_pageSize;
+
+    if (m_verifyChecksums)
+    {
+        for (int64_t page = 0; page < m_bufferPageCount; ++page)
+        {
+            verifyChecksum(page);
+        }
+    }
+
+    return m_bufferPageCount > 0;
 }
 
-void PagedBinaryFileReader::fillBuffer()
+void PagedBinaryFileReader::verifyChecksum(int64_t page) const
 {
-    m_buffer.clear();
-    char byte;
-    for (int i = 0; i < m_pageSize; ++i)
+    const auto* pageData =
+        reinterpret_cast<const uint8_t*>(m_buffer.data() + page * m_pageSize);
+    const uint8_t* stored = pageData + m_pageSize - 4;
+
+    // the checksum is stored big-endian at the end of the page
+    uint32_t expected = (static_cast<uint32_t>(stored[0]) << 24) |
+                        (static_cast<uint32_t>(stored[1]) << 16) |
+                        (static_cast<uint32_t>(stored[2]) << 8) |
+                        static_cast<uint32_t>(stored[3]);
+
+    if (crc32c(pageData, m_pageSize - 4) != expected)
     {
-        m_file.get(byte);
-        m_buffer.push_back(byte);
+        throw std::runtime_error("Checksum mismatch in page " +
+                                 std::to_string(m_bufferFirstPage + page) +
+                                 ".");
     }
-    m_currentPayloadIndex = 0;
-    m_endOfFile = m_file.eof();
 }
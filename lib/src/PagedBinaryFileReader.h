@@ -10,26 +10,55 @@
 #include <string>
 #include <vector>
 
+/**
+ * Reads the logical byte stream of a paged E57 file. Every physical page
+ * consists of a payload followed by a 4 byte CRC-32C checksum. Pages are read
+ * in large blocks and the payloads are copied out in bulk, skipping the
+ * checksums.
+ */
 class PagedBinaryFileReader
 {
 public:
+    /**
+     * @param filename Path to the paged file.
+     * @param pageSize Physical page size in bytes.
+     * @param payloadSize Payload bytes per page (page size minus checksum).
+     * @param verifyChecksums If true, the CRC-32C of every page read is
+     * verified and a runtime exception is thrown on mismatch.
+     */
     explicit PagedBinaryFileReader(const std::string& filename,
                                    int64_t pageSize = 1024,
-                                   int64_t payloadSize = 1020);
+                                   int64_t payloadSize = 1020,
+                                   bool verifyChecksums = false);
 
+    /**
+     * Copies up to numBytes logical bytes into the given buffer.
+     * @return Number of bytes copied. Less than numBytes at end of file.
+     */
+    int64_t readBytes(char* bytes, int64_t numBytes);
     bool readBytes(std::vector<char>& bytes, int64_t numBytes);
-    void seek(std::streampos pos);
+
+    /**
+     * Positions the reader at the given physical file offset.
+     */
+    void seek(int64_t pos);
 
 private:
+    static const int64_t PAGES_PER_BLOCK = 256;
+
     std::ifstream m_file;
     int64_t m_pageSize = 1024;
     int64_t m_payloadSize = 1020;
+    bool m_verifyChecksums{};
 
     std::vector<char> m_buffer;
-    int m_currentPayloadIndex{};
-    bool m_endOfFile{};
+    int64_t m_bufferFirstPage{};
+    int64_t m_bufferPageCount{};
+    int64_t m_currentPage{};
+    int64_t m_currentPayloadIndex{};
 
-    void fillBuffer();
+    bool fillBuffer();
+    void verifyChecksum(int64_t page) const;
 };
 
 #endif // E57INSPECTOR_PAGEDBINARYFILEREADER_H
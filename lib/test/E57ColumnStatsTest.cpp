@@ -0,0 +1,81 @@
+#include <e57inspector/E57ColumnStats.h>
+
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace
+{
+int failures = 0;
+
+void check(bool condition, const char* message)
+{
+    if (!condition)
+    {
+        std::cerr << "FAILED: " << message << "\n";
+        ++failures;
+    }
+}
+
+template <typename T>
+bool throwsFor(T value, size_t position)
+{
+    // long enough for the SIMD loop and the scalar tail
+    std::vector<T> values(11, T(1));
+    values[position] = value;
+
+    E57ColumnStatsAccumulator accumulator;
+    try
+    {
+        accumulator.add(std::span<const T>(values));
+    }
+    catch (const std::runtime_error&)
+    {
+        return accumulator.count() == 0;
+    }
+    return false;
+}
+
+template <typename T> void testNonFinite()
+{
+    const T nan = std::numeric_limits<T>::quiet_NaN();
+    const T inf = std::numeric_limits<T>::infinity();
+    for (size_t position : {0, 5, 10})
+    {
+        check(throwsFor(nan, position), "NaN is rejected");
+        check(throwsFor(inf, position), "infinity is rejected");
+        check(throwsFor(-inf, position), "-infinity is rejected");
+    }
+}
+
+template <typename T> void testStats()
+{
+    std::vector<T> values;
+    for (int i = 0; i < 101; ++i)
+    {
+        values.push_back(static_cast<T>(i));
+    }
+
+    E57ColumnStatsAccumulator accumulator;
+    accumulator.add(std::span<const T>(values).first(50));
+    accumulator.add(std::span<const T>(values).subspan(50));
+    auto stats = accumulator.result("intensity");
+
+    check(stats.count == 101, "count");
+    check(stats.minValue == 0.0 && stats.maxValue == 100.0, "min and max");
+    check(stats.mean == 50.0, "mean");
+    check(std::abs(stats.percentile(50.0) - 50.0) < 1.0, "median");
+    check(stats.normalize(25.0f) == 0.25f, "normalize");
+}
+} // namespace
+
+int main()
+{
+    testNonFinite<float>();
+    testNonFinite<double>();
+    testStats<float>();
+    testStats<double>();
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,128 @@
+#include <e57inspector/E57Reader.h>
+
+#include "generator.h"
+
+#include <atomic>
+#include <filesystem>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+constexpr uint32_t SCANS = 6;
+constexpr uint64_t POINTS = 25000;
+constexpr uint32_t BUFFER_SIZE = 4096;
+
+int failures = 0;
+
+void check(bool condition, const char* message)
+{
+    if (!condition)
+    {
+        std::cerr << "FAILED: " << message << "\n";
+        ++failures;
+    }
+}
+
+std::vector<uint32_t> scanDataIds(const E57Reader& reader)
+{
+    std::vector<uint32_t> dataIds;
+    for (const auto& data3D : reader.root()->data3D())
+    {
+        dataIds.push_back(data3D->data().at("points"));
+    }
+    return dataIds;
+}
+
+void testRecordCounts(const E57Reader& reader)
+{
+    const auto dataIds = scanDataIds(reader);
+    check(dataIds.size() == SCANS, "every scan is listed");
+
+    std::mutex mutex;
+    std::map<uint32_t, uint64_t> recordsRead;
+    std::map<uint32_t, uint64_t> recordCounts;
+    reader.decodeScans(dataIds, 3,
+                       [&](uint32_t dataId, E57DataReader& dataReader)
+                       {
+                           std::vector<float> x(BUFFER_SIZE);
+                           dataReader.bindBuffer("cartesianX", x.data(),
+                                                 BUFFER_SIZE);
+                           uint64_t count = 0;
+                           uint64_t read;
+                           while ((read = dataReader.read()) > 0)
+                           {
+                               count += read;
+                           }
+
+                           std::lock_guard lock(mutex);
+                           recordsRead[dataId] = count;
+                           recordCounts[dataId] = dataReader.recordCount();
+                       });
+
+    check(recordsRead.size() == SCANS, "every scan is decoded once");
+    for (uint32_t dataId : dataIds)
+    {
+        check(recordsRead[dataId] == POINTS, "all records are read");
+        check(recordCounts[dataId] == POINTS, "record count");
+    }
+}
+
+void testException(const E57Reader& reader)
+{
+    std::atomic<uint32_t> calls{0};
+    try
+    {
+        reader.decodeScans(scanDataIds(reader), 3,
+                           [&calls](uint32_t, E57DataReader&)
+                           {
+                               ++calls;
+                               throw std::runtime_error("decode failed");
+                           });
+        check(false, "the exception of a callback is rethrown");
+    }
+    catch (const std::runtime_error& e)
+    {
+        check(std::string(e.what()) == "decode failed",
+              "the exception of the callback is rethrown");
+    }
+    // every worker stops after its first failing scan
+    check(calls > 0 && calls <= 3, "remaining scans are skipped");
+
+    bool thrown = false;
+    try
+    {
+        reader.decodeScans({SCANS + 100}, 1, [](uint32_t, E57DataReader&) {});
+    }
+    catch (const std::runtime_error&)
+    {
+        thrown = true;
+    }
+    check(thrown, "an invalid data id is rejected");
+}
+} // namespace
+
+int main()
+{
+    const auto filename = std::filesystem::temp_directory_path() /
+                          "e57inspector_decode_scans_test.e57";
+
+    GeneratorOptions options;
+    options.scans = SCANS;
+    options.points = POINTS;
+    options.intensity = true;
+    Generator(options).generate(filename.string());
+
+    {
+        E57Reader reader(filename.string());
+        testRecordCounts(reader);
+        testException(reader);
+    }
+
+    std::filesystem::remove(filename);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,134 @@
+#include <e57inspector/E57Spherical.h>
+
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+// relative to the range, a few float ulp
+constexpr double TOLERANCE = 1e-6;
+// not a multiple of the SIMD width, so the scalar tail runs as well
+constexpr size_t SIZE = 1000003;
+constexpr double PI = 3.14159265358979323846;
+
+int failures = 0;
+
+void check(bool condition, const std::string& message)
+{
+    if (!condition)
+    {
+        std::cerr << "FAILED: " << message << "\n";
+        ++failures;
+    }
+}
+
+/**
+ * @return Maximum error of the conversion relative to the range, against a
+ * double precision reference.
+ */
+double maxRelativeError(const std::vector<float>& range,
+                        const std::vector<float>& elevation,
+                        const std::vector<float>& azimuth)
+{
+    std::vector<std::array<float, 3>> xyz(range.size());
+    sphericalToCartesian(range, elevation, azimuth, xyz);
+
+    double result = 0.0;
+    for (size_t i = 0; i < range.size(); ++i)
+    {
+        const double r = range[i];
+        const double projected = r * std::cos(double{elevation[i]});
+        const std::array<double, 3> expected = {
+            projected * std::cos(double{azimuth[i]}),
+            projected * std::sin(double{azimuth[i]}),
+            r * std::sin(double{elevation[i]})};
+        for (size_t j = 0; j < 3; ++j)
+        {
+            result = std::max(result, std::abs(xyz[i][j] - expected[j]) / r);
+        }
+    }
+    return result;
+}
+
+void testRandom()
+{
+    std::vector<float> range(SIZE);
+    std::vector<float> elevation(SIZE);
+    std::vector<float> azimuth(SIZE);
+    std::mt19937 random(1);
+    std::uniform_real_distribution<float> rangeDistribution(0.1f, 100.0f);
+    std::uniform_real_distribution<float> elevationDistribution(-PI / 2.0,
+                                                                PI / 2.0);
+    std::uniform_real_distribution<float> azimuthDistribution(-PI, PI);
+    // angles of up to 8192 radians are supported
+    std::uniform_real_distribution<float> largeAngleDistribution(-8192.0f,
+                                                                 8192.0f);
+    for (size_t i = 0; i < SIZE; ++i)
+    {
+        range[i] = rangeDistribution(random);
+        elevation[i] = elevationDistribution(random);
+        azimuth[i] = i % 2 == 0 ? azimuthDistribution(random)
+                                : largeAngleDistribution(random);
+    }
+
+    const double error = maxRelativeError(range, elevation, azimuth);
+    check(error <= TOLERANCE,
+          "maximum relative error " + std::to_string(error));
+}
+
+void testOctantBoundaries()
+{
+    std::vector<float> angles;
+    for (int octant = -16; octant <= 16; ++octant)
+    {
+        const auto angle = static_cast<float>(octant * PI / 4.0);
+        angles.insert(angles.end(),
+                      {std::nextafter(angle, -INFINITY), angle,
+                       std::nextafter(angle, INFINITY)});
+    }
+
+    std::vector<float> range(angles.size(), 1.0f);
+    const double error = maxRelativeError(range, angles, angles);
+    check(error <= TOLERANCE,
+          "maximum relative error at octant boundaries " +
+              std::to_string(error));
+}
+
+void testSizeMismatch()
+{
+    std::vector<float> values(9);
+    std::vector<std::array<float, 3>> xyz(8);
+    bool thrown = false;
+    try
+    {
+        sphericalToCartesian(values, values, values, xyz);
+    }
+    catch (const std::runtime_error&)
+    {
+        thrown = true;
+    }
+    check(thrown, "mismatching sizes are rejected");
+}
+} // namespace
+
+/**
+ * @param argv Optionally the instruction set the kernel is expected to use.
+ */
+int main(int argc, char* argv[])
+{
+    const std::string instructionSet = sphericalToCartesianInstructionSet();
+    std::cout << "sphericalToCartesian: " << instructionSet << std::endl;
+    if (argc > 1)
+    {
+        check(instructionSet == argv[1], "instruction set " + instructionSet);
+    }
+
+    testRandom();
+    testOctantBoundaries();
+    testSizeMismatch();
+    return failures == 0 ? 0 : 1;
+}
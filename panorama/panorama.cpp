@@ -1,50 +1,73 @@
 #include "panorama.h"
 
 #include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <e57inspector/E57ColumnReader.h>
 #include <e57inspector/E57Reader.h>
 #include <iostream>
+#include <iterator>
 #include <stdexcept>
 #include <utility>
-#include <cmath>
 
 static const int BUFFER_SIZE = 10000;
 
-Panorama::Panorama(std::string filename) : m_filename(std::move(filename)) {}
-
-std::array<float, 3> sphericalToCartesian(const std::array<float, 3> rtp)
+Panorama::Panorama(std::string filename, const E57ReaderOptions& options)
+    : m_filename(std::move(filename)), m_options(options)
 {
-    const float r = rtp[0];
-    const float sinTheta = std::sin(rtp[1]);
-    const float sinPhi = std::sin(rtp[2]);
-    const float cosTheta = std::cos(rtp[1]);
-    const float cosPhi = std::cos(rtp[2]);
-    return std::array<float, 3>{r * cosTheta * cosPhi, r * cosTheta * sinPhi,
-                                r * sinTheta};
 }
 
-E57Data3DPtr findData3DByGuid(const E57Reader& reader, const std::string& guid)
+Panorama::~Panorama() = default;
+
+std::unique_ptr<E57Reader> Panorama::acquireReader() const
 {
-    for (const auto& data3d : reader.root()->data3D())
     {
-        const std::string data3DGuid = data3d->getString("guid");
-        if (data3DGuid == guid)
+        std::lock_guard lock(m_mutex);
+        if (!m_readers.empty())
         {
-            return data3d;
+            auto reader = std::move(m_readers.back());
+            m_readers.pop_back();
+            return reader;
         }
     }
-    return nullptr;
+    // opened outside the lock, other panoramas go on meanwhile
+    return std::make_unique<E57Reader>(m_filename, m_options);
+}
+
+void Panorama::releaseReader(std::unique_ptr<E57Reader> reader) const
+{
+    std::lock_guard lock(m_mutex);
+    m_readers.push_back(std::move(reader));
 }
 
 PanoramaImage Panorama::createPanorama(const std::string& data3dGuid) const
 {
     PanoramaImage result;
-    const auto& reader = std::make_unique<E57Reader>(m_filename);
-
-    E57Data3DPtr data3DPtr = findData3DByGuid(*reader, data3dGuid);
-    if (!data3DPtr)
+    auto reader = acquireReader();
+    // back to the pool also if the panorama cannot be created
+    struct Release
+    {
+        const Panorama& panorama;
+        std::unique_ptr<E57Reader>& reader;
+        ~Release() { panorama.releaseReader(std::move(reader)); }
+    } release{*this, reader};
+
+    // all readers of the file list the scans in the same order
+    const auto& scans = reader->root()->data3D();
+    std::call_once(m_guidIndexBuilt,
+                   [this, &scans]()
+                   {
+                       for (size_t i = 0; i < scans.size(); ++i)
+                       {
+                           m_guidIndex.emplace(scans[i]->getString("guid"), i);
+                       }
+                   });
+    auto scan = m_guidIndex.find(data3dGuid);
+    if (scan == m_guidIndex.end() || scan->second >= scans.size())
     {
         throw std::runtime_error("Could not find Data3D with specified GUID.");
     }
+    E57Data3DPtr data3DPtr = scans[scan->second];
 
     auto indexBoundsIt = std::find_if(
         data3DPtr->children().begin(), data3DPtr->children().end(),
@@ -57,9 +80,10 @@ PanoramaImage Panorama::createPanorama(const std::string& data3dGuid) const
     const auto& indexBounds = *indexBoundsIt;
     result.height = indexBounds->getInteger("rowMaximum");
     result.width = indexBounds->getInteger("columnMaximum");
-    result.data.resize(result.height * result.width * 4, 0);
+    result.data.resize(size_t{result.height} * result.width * 4, 0);
 
-    auto dataInfo = reader->dataInfo(data3DPtr->data().at("points"));
+    const uint32_t dataId = data3DPtr->data().at("points");
+    auto dataInfo = reader->dataInfo(dataId);
 
     auto hasAttribute = [&dataInfo](const std::string& name)
     {
@@ -68,52 +92,23 @@ PanoramaImage Panorama::createPanorama(const std::string& data3dGuid) const
                            { return info.identifier == name; });
     };
 
-    auto dataReader = reader->dataReader(data3DPtr->data().at("points"));
-
-    bool hasColor = false;
-    bool hasIntensity = false;
-    std::vector<std::array<float, 3>> rgb(0);
+    std::array<std::string, 3> colors;
     if (hasAttribute("colorRed") && hasAttribute("colorGreen") &&
         hasAttribute("colorBlue"))
     {
-        rgb.resize(BUFFER_SIZE);
-        hasColor = true;
-        dataReader.bindBuffer("colorRed", (float*)&rgb[0][0], rgb.size(),
-                              3 * sizeof(float));
-        dataReader.bindBuffer("colorGreen", (float*)&rgb[0][1], rgb.size(),
-                              3 * sizeof(float));
-        dataReader.bindBuffer("colorBlue", (float*)&rgb[0][2], rgb.size(),
-                              3 * sizeof(float));
+        colors = {"colorRed", "colorGreen", "colorBlue"};
     }
 
-    std::vector<float> intensity(0);
-    if (hasAttribute("intensity"))
-    {
-        intensity.resize(BUFFER_SIZE);
-        hasIntensity = true;
-        dataReader.bindBuffer("intensity", (float*)&intensity[0],
-                              intensity.size());
-    }
-
-    bool hasColumnIndex = false;
-    std::vector<uint32_t> columnIndex(0);
-    if (hasAttribute("columnIndex"))
-    {
-        hasColumnIndex = true;
-        columnIndex.resize(BUFFER_SIZE);
-        dataReader.bindBuffer("columnIndex", (uint32_t*)&columnIndex[0],
-                              columnIndex.size());
-    }
+    E57ColumnReader<float, float, float, float, uint32_t, uint32_t> dataReader(
+        reader->dataReader(dataId),
+        {colors[0], colors[1], colors[2], "intensity", "rowIndex",
+         "columnIndex"},
+        BUFFER_SIZE);
 
-    bool hasRowIndex = false;
-    std::vector<uint32_t> rowIndex(0);
-    if (hasAttribute("rowIndex"))
-    {
-        hasRowIndex = true;
-        rowIndex.resize(BUFFER_SIZE);
-        dataReader.bindBuffer("rowIndex", (uint32_t*)&rowIndex[0],
-                              rowIndex.size());
-    }
+    const bool hasColor = dataReader.hasColumn<0>();
+    const bool hasIntensity = dataReader.hasColumn<3>();
+    const bool hasRowIndex = dataReader.hasColumn<4>();
+    const bool hasColumnIndex = dataReader.hasColumn<5>();
 
     if (!hasRowIndex || !hasColumnIndex)
     {
@@ -125,76 +120,109 @@ PanoramaImage Panorama::createPanorama(const std::string& data3dGuid) const
         throw std::runtime_error("Data3D has no color or intensity.");
     }
 
-    struct Data
+    // intensity is only used without color. With cached statistics it is
+    // normalized while decoding. Otherwise they are accumulated on the way
+    // and each pixel holds its raw value as a float in its four bytes until
+    // all points are read, the pixels which got a point are flagged.
+    // Non-finite intensities are skipped, the pixel stays black.
+    const bool useIntensity = !hasColor && hasIntensity;
+    auto intensityStats = useIntensity
+                              ? reader->cachedColumnStats(dataId, "intensity")
+                              : std::nullopt;
+    const bool deferIntensity = useIntensity && !intensityStats;
+    E57ColumnStatsAccumulator intensityAccumulator;
+    // statistics without the skipped values are not those of the column
+    bool cacheStats = true;
+    std::vector<float> finiteIntensity;
+    std::vector<bool> hasPoint(deferIntensity ? result.data.size() / 4 : 0);
+
+    auto isFinite = [](float value) { return std::isfinite(value); };
+    static_assert(sizeof(float) == 4);
+
+    // every batch is written straight into the image, only the image and
+    // one batch are held in memory
+    while (dataReader.read() > 0)
     {
-        std::vector<float> intensity;
-        std::vector<std::array<float, 4>> rgba;
-        std::vector<uint32_t> rowIndex;
-        std::vector<uint32_t> columnIndex;
-    };
+        auto red = dataReader.column<0>();
+        auto green = dataReader.column<1>();
+        auto blue = dataReader.column<2>();
+        auto intensity = dataReader.column<3>();
+        auto rowIndex = dataReader.column<4>();
+        auto columnIndex = dataReader.column<5>();
+
+        if (deferIntensity)
+        {
+            if (std::all_of(intensity.begin(), intensity.end(), isFinite))
+            {
+                intensityAccumulator.add(intensity);
+            }
+            else
+            {
+                finiteIntensity.clear();
+                std::copy_if(intensity.begin(), intensity.end(),
+                             std::back_inserter(finiteIntensity), isFinite);
+                intensityAccumulator.add(
+                    std::span<const float>(finiteIntensity));
+                cacheStats = false;
+            }
+        }
 
-    uint64_t count;
-    Data data;
-    while ((count = dataReader.read()) > 0)
-    {
-        for (size_t i = 0; i < count; ++i)
+        for (size_t i = 0; i < dataReader.size(); ++i)
         {
+            if (rowIndex[i] >= result.height || columnIndex[i] >= result.width)
+                continue;
+
+            const size_t row = result.height - rowIndex[i] - 1;
+            const size_t index = row * result.width + columnIndex[i];
+            uint8_t* pixel = &result.data[index * 4];
             if (hasColor)
             {
-                data.rgba.push_back({rgb[i][0] / 255.0f, rgb[i][1] / 255.0f,
-                                     rgb[i][2] / 255.0f, 1.0f});
+                pixel[0] = static_cast<uint8_t>(red[i] / 255.0f * 255);
+                pixel[1] = static_cast<uint8_t>(green[i] / 255.0f * 255);
+                pixel[2] = static_cast<uint8_t>(blue[i] / 255.0f * 255);
             }
-            else if (hasIntensity)
+            else if (!isFinite(intensity[i]))
             {
-                data.intensity.push_back(intensity[i]);
+                continue;
+            }
+            else if (deferIntensity)
+            {
+                std::memcpy(pixel, &intensity[i], 4);
+                hasPoint[index] = true;
+            }
+            else
+            {
+                const auto value = static_cast<uint8_t>(
+                    intensityStats->normalize(intensity[i]) * 255);
+                pixel[0] = value;
+                pixel[1] = value;
+                pixel[2] = value;
             }
-
-            data.rowIndex.push_back(rowIndex[i]);
-            data.columnIndex.push_back(columnIndex[i]);
         }
     }
 
     // map intensity between [0;1]
-    if (!data.intensity.empty())
+    if (deferIntensity)
     {
-        float minIntensity =
-            *std::min_element(data.intensity.begin(), data.intensity.end());
-        float maxIntensity =
-            *std::max_element(data.intensity.begin(), data.intensity.end());
-        std::for_each(data.intensity.begin(), data.intensity.end(),
-                      [minIntensity, maxIntensity](auto& intensity)
-                      {
-                          intensity -= minIntensity;
-                          intensity /= (maxIntensity - minIntensity);
-                      });
-    }
-
-    // create final image
-    for (int i = 0; i < data.columnIndex.size(); ++i)
-    {
-        if (data.rowIndex[i] < result.height && data.rowIndex[i] >= 0 &&
-            data.columnIndex[i] < result.width && data.columnIndex[i] >= 0)
+        auto stats = intensityAccumulator.result("intensity");
+        if (cacheStats)
         {
-            auto row = result.height - data.rowIndex[i] - 1;
-            auto col = data.columnIndex[i];
-            if (hasColor)
-            {
-                result.data[(row * result.width + col) * 4 + 0] =
-                    static_cast<uint8_t>(data.rgba[i][0] * 255);
-                result.data[(row * result.width + col) * 4 + 1] =
-                    static_cast<uint8_t>(data.rgba[i][1] * 255);
-                result.data[(row * result.width + col) * 4 + 2] =
-                    static_cast<uint8_t>(data.rgba[i][2] * 255);
-            }
-            else if (hasIntensity)
+            reader->setColumnStats(dataId, stats);
+        }
+        for (size_t i = 0; i < hasPoint.size(); ++i)
+        {
+            uint8_t* pixel = &result.data[i * 4];
+            uint8_t value = 0;
+            if (hasPoint[i])
             {
-                result.data[(row * result.width + col) * 4 + 0] =
-                    static_cast<uint8_t>(data.intensity[i] * 255);
-                result.data[(row * result.width + col) * 4 + 1] =
-                    static_cast<uint8_t>(data.intensity[i] * 255);
-                result.data[(row * result.width + col) * 4 + 2] =
-                    static_cast<uint8_t>(data.intensity[i] * 255);
+                float raw;
+                std::memcpy(&raw, pixel, 4);
+                value = static_cast<uint8_t>(stats.normalize(raw) * 255);
             }
+            pixel[0] = value;
+            pixel[1] = value;
+            pixel[2] = value;
+            pixel[3] = 0;
         }
     }
 
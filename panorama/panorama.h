@@ -1,9 +1,14 @@
 #ifndef E57INSPECTOR_PANORAMA_H
 #define E57INSPECTOR_PANORAMA_H
 
+#include <cstdint>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 #include <vector>
-#include <cstdint>
+
+#include <e57inspector/E57Reader.h>
 
 struct PanoramaImage
 {
@@ -12,13 +17,27 @@ struct PanoramaImage
     std::vector<uint8_t> data;
 };
 
+/**
+ * Creates panoramas of the scans of one file. The readers opened for it are
+ * kept and reused by later panoramas, so the file is opened once per
+ * panorama created at the same time rather than once per panorama. Scans are
+ * looked up by an index of their GUIDs. Panoramas may be created from
+ * several threads at once.
+ */
 class Panorama
 {
 public:
     /**
      * @param filename Path to an E57 file.
+     * @param options Options of the readers opened for the panoramas.
      */
-    explicit Panorama(std::string filename);
+    explicit Panorama(std::string filename,
+                      const E57ReaderOptions& options = {.lazy = true,
+                                                         .useIndex = true});
+    ~Panorama();
+
+    Panorama(const Panorama&) = delete;
+    Panorama& operator=(const Panorama&) = delete;
 
     /**
      * Creates a panorama image from the scan data.
@@ -33,6 +52,17 @@ public:
 
 private:
     std::string m_filename;
+    E57ReaderOptions m_options;
+
+    mutable std::mutex m_mutex;
+    // readers not in use
+    mutable std::vector<std::unique_ptr<E57Reader>> m_readers;
+    // position of each scan within the data3D vector
+    mutable std::unordered_map<std::string, size_t> m_guidIndex;
+    mutable std::once_flag m_guidIndexBuilt;
+
+    [[nodiscard]] std::unique_ptr<E57Reader> acquireReader() const;
+    void releaseReader(std::unique_ptr<E57Reader> reader) const;
 };
 
 #endif // E57INSPECTOR_PANORAMA_H